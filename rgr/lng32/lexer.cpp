@@ -5,6 +5,9 @@
 #include <utility>
 #include "../stack_lng/polynomial.hpp"
 #include "../stack_lng/polynomial.cpp"
+#include "../stack_lng/polynomial_parallel.cpp"
+#include "../stack_lng/thread_pool.cpp"
+#include "../stack_lng/polynomial_alloc.cpp"
 
 // перечисление классов символьных лексем
 //
@@ -0,0 +1,58 @@
+#!/usr/bin/env python3
+#
+# сравнение результатов bench_polynomial с сохранённым базовым результатом
+#
+# запуск : python3 bench_compare.py <базовый.json> <новый.json> [--threshold 0.10]
+#
+# случай считается регрессией, если новое время больше базового более чем на threshold (доля) ;
+# при найденных регрессиях скрипт завершается с кодом 1
+
+import argparse
+import json
+import sys
+
+
+def load(filename):
+    with open(filename) as file:
+        data = json.load(file)
+    if data.get("version") != 1:
+        sys.exit(f"{filename} : неизвестная версия формата")
+    return {result["name"]: result["ns_per_op"] for result in data["results"]}
+
+
+def main():
+    arguments = argparse.ArgumentParser(description="сравнение результатов bench_polynomial")
+    arguments.add_argument("baseline")
+    arguments.add_argument("current")
+    arguments.add_argument("--threshold", type=float, default=0.10,
+                           help="допустимое относительное замедление (по умолчанию 0.10)")
+    args = arguments.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    print(f"{'случай':<40} {'база, нс':>12} {'сейчас, нс':>12} {'изменение':>10}")
+    for name, ns in current.items():
+        if name not in baseline:
+            print(f"{name:<40} {'---':>12} {ns:>12.1f} {'новый':>10}")
+            continue
+
+        change = ns / baseline[name] - 1
+        mark = ""
+        if change > args.threshold:
+            mark = "  <-- регрессия"
+            regressions += 1
+
+        print(f"{name:<40} {baseline[name]:>12.1f} {ns:>12.1f} {change:>+10.1%}{mark}")
+
+    for name in baseline:
+        if name not in current:
+            print(f"{name:<40} (нет в новом результате)")
+
+    print(f"\nрегрессий : {regressions}")
+    sys.exit(1 if regressions else 0)
+
+
+if __name__ == "__main__":
+    main()
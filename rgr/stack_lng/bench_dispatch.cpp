@@ -0,0 +1,130 @@
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "interpreter.cpp"
+
+/* 	сравнение способов выбора команд интерпретатором (switch и шитый код) на прилагаемых программах
+*
+*	каждая программа разбирается один раз, затем исполняется COUNT_RUNS раз в каждом режиме
+*	(и ещё раз с шитым кодом и проверками размера стека) ;
+*	ввод программы подаётся из строки, вывод отбрасывается ; печатается лучшее время одного запуска
+*
+*	с параметром --sequences программы исполняются один раз без суперкоманд с подсчётом команд,
+*	и печатаются последовательности команд, которые выгоднее всего слить в суперкоманды (по всем программам)
+*
+*	параметры запуска : ./bench_dispatch.exe [--sequences] [каталог с программами]
+*/
+
+static const int COUNT_RUNS = 20;
+
+struct DispatchCase {
+	const char* filename;
+	const char* input;		// то, что программа прочитает командой read
+};
+
+static const DispatchCase CASES[] = {
+	{ "input1",  "" },
+	{ "input2",  "42" },
+	{ "input3",  "12" },
+	{ "input4",  "100003" },		// основной цикл выполняется около ста тысяч раз
+	{ "input5",  "" },
+	{ "minput2", "" },
+};
+
+// один запуск : ввод берётся из строки, вывод отбрасывается
+static void run_silently(Interpreter& interpreter, const char* input) {
+	interpreter.get_input().open_string(input);
+	interpreter.get_output().capture(nullptr);
+
+	interpreter.run();
+}
+
+// лучшее время одного запуска (в секундах)
+static double measure(Interpreter& interpreter, DispatchMode mode, const char* input) {
+	interpreter.set_dispatch_mode(mode);
+
+	double best = 0;
+	for (int run = 0; run < COUNT_RUNS; run++) {
+		auto start = std::chrono::steady_clock::now();
+		run_silently(interpreter, input);
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		if (run == 0 || elapsed < best) best = elapsed;
+	}
+
+	return best;
+}
+
+int main(int argc, char* argv[]) {
+	bool        sequences = false;
+	std::string directory;
+	for (int i = 1; i < argc; i++) {
+		if (std::strcmp(argv[i], "--sequences") == 0) sequences = true;
+		else                                          directory = std::string(argv[i]) + "/";
+	}
+
+	if (sequences) {
+		SequenceCounts counts;
+		for (const DispatchCase& dispatch_case : CASES) {
+			std::string filename = directory + dispatch_case.filename;
+
+			Parser parser;
+			ParsedProgram program = parser.run(filename.c_str());
+
+			std::ostringstream errors;
+			if (program.print_errors(errors) != 0) {
+				std::cout << filename << " : программа содержит ошибки\n";
+				continue;
+			}
+
+			Interpreter interpreter(Compiler::compile(program, false));
+			interpreter.set_counting(true);
+			run_silently(interpreter, dispatch_case.input);
+			interpreter.add_sequence_counts(counts);
+		}
+
+		print_sequence_counts(counts, std::cout);
+		return 0;
+	}
+
+#if !INTERPRETER_COMPUTED_GOTO
+	std::cout << "Компилятор не поддерживает шитый код : оба режима используют switch\n";
+#endif
+
+	std::cout << "программа        switch, мкс     шитый код, мкс   ускорение   с проверками стека, мкс\n";
+	for (const DispatchCase& dispatch_case : CASES) {
+		std::string filename = directory + dispatch_case.filename;
+
+		Parser parser;
+		ParsedProgram program = parser.run(filename.c_str());
+
+		std::ostringstream errors;
+		if (program.print_errors(errors) != 0) {
+			std::cout << filename << " : программа содержит ошибки\n";
+			continue;
+		}
+
+		Interpreter interpreter(program);
+
+		double switch_time   = measure(interpreter, DispatchMode::Switch,   dispatch_case.input);
+		double threaded_time = measure(interpreter, DispatchMode::Threaded, dispatch_case.input);
+
+		// шитый код с проверками размера стека (для программ, прошедших проверку стека, их обычно нет)
+		interpreter.set_stack_checks(true);
+		double checked_time  = measure(interpreter, DispatchMode::Threaded, dispatch_case.input);
+		interpreter.set_stack_checks(false);
+
+		std::cout.width(16); std::cout.setf(std::ios::left, std::ios::adjustfield);
+		std::cout << dispatch_case.filename;
+		std::cout.setf(std::ios::right, std::ios::adjustfield);
+		std::cout.width(12); std::cout << switch_time * 1e6;
+		std::cout.width(19); std::cout << threaded_time * 1e6;
+		std::cout.width(12); std::cout << switch_time / threaded_time;
+		std::cout.width(26); std::cout << checked_time * 1e6 << '\n';
+	}
+
+	return 0;
+}
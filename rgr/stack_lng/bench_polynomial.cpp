@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "polynomial.hpp"
+#include "fixed_polynomial.hpp"
+
+/* 	микробенчмарки операций Polynomial
+*
+*	каждая операция измеряется для всех сочетаний параметров :
+*	   степень          :    16, 256, 2048
+*	   плотность        :    dense (все степени от 0 до n), sparse (каждая десятая степень)
+*	   коэффициенты     :    int (небольшие целые), real (случайные вещественные)
+*
+*	многочлены малой степени (FIXED_DEGREE) измеряются и как Polynomial, и как FixedPolynomial
+*	(имена fixed_<операция>) ; результаты FixedPolynomial сверяются с результатами Polynomial,
+*	при расхождении бенчмарк завершается с кодом 1
+*
+*	для каждого случая операция повторяется, пока серия не займёт не меньше MIN_SERIES_TIME,
+*	серия запускается COUNT_SERIES раз, в результат записывается лучшее время одной операции
+*
+*	результат записывается в JSON :
+*	   { "version": 1, "results": [ { "name": "mul/deg=256/dense/real", "ns_per_op": 1234.5, "iterations": 800 }, ... ] }
+*	и сравнивается с сохранённым результатом скриптом bench_compare.py
+*
+*	параметры запуска : ./bench.exe [параметры]
+*	   --out <файл>     :    записать JSON в файл (по умолчанию --- в stdout)
+*	   --filter <текст> :    измерять только случаи, в имени которых есть текст
+*	   --quick          :    короткие серии (для проверки, а не для сравнения)
+*/
+
+static double MIN_SERIES_TIME = 0.05;	// секунд
+static int    COUNT_SERIES    = 5;
+
+static const int DEGREES[] = { 16, 256, 2048 };
+static const int FIXED_DEGREE = 3;
+
+// вычисление FixedPolynomial на этапе компиляции (пример из fixed_polynomial.hpp)
+constexpr FixedPolynomial<3> FIXED_EXAMPLE({ 1, 0, 2 });
+static_assert(FIXED_EXAMPLE(2) == 9, "FixedPolynomial: значение на этапе компиляции");
+static_assert((FIXED_EXAMPLE * FIXED_EXAMPLE)[4] == 4 && (FIXED_EXAMPLE * FIXED_EXAMPLE).deg() == 4, "FixedPolynomial: умножение на этапе компиляции");
+static_assert(FIXED_EXAMPLE.derivative() == FixedPolynomial<2>(1, 4), "FixedPolynomial: производная на этапе компиляции");
+
+// значение, которое компилятор не может выбросить
+static volatile float sink;
+
+struct BenchResult {
+	std::string name;
+	double      ns_per_op;
+	long long   iterations;
+};
+
+struct BenchCase {
+	int  degree;
+	bool sparse;
+	bool integer_coefficients;
+
+	std::string suffix() const {
+		std::ostringstream stream;
+		stream << "/deg=" << degree << (sparse ? "/sparse" : "/dense") << (integer_coefficients ? "/int" : "/real");
+		return stream.str();
+	}
+};
+
+static Polynomial make_polynomial(const BenchCase& bench_case, std::mt19937& random, int degree) {
+	std::uniform_int_distribution<int>    integer(-9, 9);
+	std::uniform_real_distribution<float> real(-1.0f, 1.0f);
+
+	std::vector<int>   powers;
+	std::vector<float> coeffs;
+	int step = bench_case.sparse ? 10 : 1;
+	for (int pow = 0; pow <= degree; pow += step) {
+		float coeff = bench_case.integer_coefficients ? integer(random) : real(random);
+		if (coeff == 0) coeff = 1;
+
+		powers.push_back(pow);
+		coeffs.push_back(coeff);
+	}
+	// старший терм присутствует всегда
+	if (powers.back() != degree) {
+		powers.push_back(degree);
+		coeffs.push_back(1);
+	}
+
+	return Polynomial(powers.data(), coeffs.data(), powers.size());
+}
+
+// делитель со старшим коэффициентом 1 : деление на него численно устойчиво
+static Polynomial make_divisor(const BenchCase& bench_case, std::mt19937& random) {
+	BenchCase small = bench_case;
+	small.integer_coefficients = true;
+
+	int degree = std::max(1, bench_case.degree / 2);
+	return make_polynomial(small, random, degree - 1) + Polynomial(degree, 1);
+}
+
+/* время одной операции : лучшая из COUNT_SERIES серий ;
+*  operation возвращает число, которое складывается в sink */
+static BenchResult measure(const std::string& name, const std::function<float()>& operation) {
+	using Clock = std::chrono::steady_clock;
+
+	// подбор длины серии
+	long long iterations = 1;
+	while (true) {
+		Clock::time_point start = Clock::now();
+		for (long long i = 0; i < iterations; i++) sink = operation();
+		double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+		if (elapsed >= MIN_SERIES_TIME) break;
+		iterations *= elapsed > 0 ? std::min(10.0, std::max(2.0, 1.2 * MIN_SERIES_TIME / elapsed)) : 10;
+	}
+
+	double best = 0;
+	for (int series = 0; series < COUNT_SERIES; series++) {
+		Clock::time_point start = Clock::now();
+		for (long long i = 0; i < iterations; i++) sink = operation();
+		double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+		if (series == 0 || elapsed < best) best = elapsed;
+	}
+
+	return { name, best * 1e9 / iterations, iterations };
+}
+
+static void run_case(const BenchCase& bench_case, const std::string& filter, std::vector<BenchResult>& results) {
+	std::mt19937 random(bench_case.degree * 4 + bench_case.sparse * 2 + bench_case.integer_coefficients);
+
+	Polynomial p1 = make_polynomial(bench_case, random, bench_case.degree);
+	Polynomial p2 = make_polynomial(bench_case, random, bench_case.degree);
+	Polynomial divisor = make_divisor(bench_case, random);
+	Polynomial p1_copy = p1;
+
+	std::ostringstream text_stream;
+	text_stream << p1;
+	std::string text = text_stream.str();
+
+	std::vector<int>   powers;
+	std::vector<float> coeffs;
+	for (auto& _term : p1) {
+		powers.push_back(_term.power);
+		coeffs.push_back(_term.coefficient);
+	}
+
+	std::string suffix = bench_case.suffix();
+	auto bench = [&](const char* operation_name, const std::function<float()>& operation) {
+		std::string name = operation_name + suffix;
+		if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+		results.push_back(measure(name, operation));
+		std::cerr << name << " : " << results.back().ns_per_op << " ns\n";
+	};
+
+	bench("construct", [&]() { Polynomial p(powers.data(), coeffs.data(), powers.size()); return p[0]; });
+	bench("copy",      [&]() { Polynomial p(p1); return p[0]; });
+	bench("move",      [&]() { Polynomial p(std::move(p1)); p1 = std::move(p); return p1[0]; });
+	bench("add",       [&]() { return (p1 + p2)[0]; });
+	bench("sub",       [&]() { return (p1 - p2)[0]; });
+	bench("mul",       [&]() { return (p1 * p2)[0]; });
+	bench("div",       [&]() { return (p1 / divisor)[0]; });
+	bench("mod",       [&]() { return (p1 % divisor)[0]; });
+	bench("eval",      [&]() { return p1(0.999f); });
+	bench("derivative",[&]() { return p1.derivative()[0]; });
+	bench("deg",       [&]() { return (float)p1.deg(); });
+	bench("equal",     [&]() { return (float)(p1 == p1_copy); });
+	bench("write",     [&]() { std::ostringstream stream; stream << p1; return (float)stream.tellp(); });
+	bench("read",      [&]() { std::istringstream stream(text); Polynomial p; stream >> p; return p[0]; });
+}
+
+// коэффициенты совпадают с точностью до округления (порядок сложений у Polynomial и FixedPolynomial разный)
+static bool same_coefficients(const Polynomial& expected, const Polynomial& got) {
+	int degree = std::max(expected.deg(), got.deg());
+	for (int pow = 0; pow <= degree; pow++) {
+		if (std::fabs(expected[pow] - got[pow]) > 1e-5f * (1 + std::fabs(expected[pow]))) return false;
+	}
+	return true;
+}
+
+/* многочлены степени FIXED_DEGREE : те же операции у Polynomial и FixedPolynomial<FIXED_DEGREE + 1> ;
+*  false, если результаты FixedPolynomial не совпали с результатами Polynomial */
+static bool run_fixed_case(bool integer_coefficients, const std::string& filter, std::vector<BenchResult>& results) {
+	typedef FixedPolynomial<FIXED_DEGREE + 1> Fixed;
+
+	BenchCase bench_case = { FIXED_DEGREE, false, integer_coefficients };
+	std::mt19937 random(bench_case.degree * 4 + bench_case.integer_coefficients);
+
+	Polynomial p1 = make_polynomial(bench_case, random, bench_case.degree);
+	Polynomial p2 = make_polynomial(bench_case, random, bench_case.degree);
+	Fixed f1(p1), f2(p2);
+
+	bool correct = same_coefficients(p1 + p2, f1 + f2)
+		&& same_coefficients(p1 - p2, f1 - f2)
+		&& same_coefficients(p1 * p2, f1 * f2)
+		&& same_coefficients(p1.derivative(), f1.derivative())
+		&& std::fabs(p1(0.999f) - f1(0.999f)) <= 1e-5f * (1 + std::fabs(p1(0.999f)))
+		&& f1.deg() == p1.deg();
+	if (!correct) {
+		std::cerr << "FixedPolynomial не совпадает с Polynomial" << bench_case.suffix() << " : " << f1 << " , " << f2 << '\n';
+		return false;
+	}
+
+	std::string suffix = bench_case.suffix();
+	auto bench = [&](const char* operation_name, const std::function<float()>& operation) {
+		std::string name = operation_name + suffix;
+		if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+		results.push_back(measure(name, operation));
+		std::cerr << name << " : " << results.back().ns_per_op << " ns\n";
+	};
+
+	bench("add",              [&]() { return (p1 + p2)[0]; });
+	bench("fixed_add",        [&]() { return (f1 + f2)[0]; });
+	bench("mul",              [&]() { return (p1 * p2)[0]; });
+	bench("fixed_mul",        [&]() { return (f1 * f2)[0]; });
+	bench("eval",             [&]() { return p1(0.999f); });
+	bench("fixed_eval",       [&]() { return f1(0.999f); });
+	bench("derivative",       [&]() { return p1.derivative()[0]; });
+	bench("fixed_derivative", [&]() { return f1.derivative()[0]; });
+	bench("fixed_convert",    [&]() { return Polynomial(f1)[0]; });
+	return true;
+}
+
+static void write_json(std::ostream& stream, const std::vector<BenchResult>& results) {
+	stream << "{\n  \"version\": 1,\n  \"results\": [\n";
+	for (int i = 0; i < results.size(); i++) {
+		stream << "    { \"name\": \"" << results[i].name << "\", \"ns_per_op\": " << results[i].ns_per_op
+			   << ", \"iterations\": " << results[i].iterations << " }";
+		if (i != results.size() - 1) stream << ',';
+		stream << '\n';
+	}
+	stream << "  ]\n}\n";
+}
+
+int main(int argc, char* argv[]) {
+	const char* out_filename = nullptr;
+	std::string filter;
+
+	for (int i = 1; i < argc; ++i) {
+		if      (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc)    out_filename = argv[++i];
+		else if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) filter = argv[++i];
+		else if (std::strcmp(argv[i], "--quick") == 0) {
+			MIN_SERIES_TIME = 0.005;
+			COUNT_SERIES = 1;
+		}
+		else {
+			std::cerr << "Неизвестный параметр : " << argv[i] << '\n';
+			return 1;
+		}
+	}
+
+	std::vector<BenchResult> results;
+	for (int integer_coefficients = 1; integer_coefficients >= 0; integer_coefficients--) {
+		if (!run_fixed_case((bool)integer_coefficients, filter, results)) return 1;
+	}
+	for (int degree : DEGREES) {
+		for (int sparse = 0; sparse <= 1; sparse++) {
+			for (int integer_coefficients = 1; integer_coefficients >= 0; integer_coefficients--) {
+				run_case({ degree, (bool)sparse, (bool)integer_coefficients }, filter, results);
+			}
+		}
+	}
+
+	if (out_filename) {
+		std::ofstream fout(out_filename);
+		write_json(fout, results);
+	}
+	else {
+		write_json(std::cout, results);
+	}
+
+	return 0;
+}
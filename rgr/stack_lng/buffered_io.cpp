@@ -0,0 +1,276 @@
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "buffered_io.hpp"
+
+#ifdef _WIN32
+#include <io.h>
+#define read_fd  ::_read
+#define write_fd ::_write
+#else
+#include <unistd.h>
+#define read_fd  ::read
+#define write_fd ::write
+#endif
+
+// самая длинная запись числа, которая разбирается целиком из буфера
+static const std::size_t MAX_NUMBER_LENGTH = 128;
+
+static bool is_space(int c) {
+	return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+}
+// символ, которым может закончиться запись числа в многочлене
+static bool is_delimiter(int c) {
+	return is_space(c) || c == ':' || c == ']';
+}
+
+// ---------------------------------------
+// ввод
+// ---------------------------------------
+
+InputBuffer::InputBuffer(int _fd) : buffer(CAPACITY + 1), tied(nullptr) {
+	bind(_fd);
+}
+
+void InputBuffer::bind(int _fd) {
+	fd = _fd;
+	begin = end = 0;
+	eof = false;
+	buffer.resize(CAPACITY + 1);
+	buffer[0] = '\0';
+}
+void InputBuffer::open_string(const std::string& text) {
+	fd = -1;
+	buffer.assign(text.begin(), text.end());
+	buffer.push_back('\0');
+	begin = 0;
+	end = text.size();
+	eof = true;
+}
+void InputBuffer::tie(OutputBuffer* output) {
+	tied = output;
+}
+
+bool InputBuffer::fill() {
+	if (eof) return false;
+	if (tied) tied->flush();
+
+	if (begin > 0) {
+		std::memmove(buffer.data(), buffer.data() + begin, end - begin);
+		end -= begin;
+		begin = 0;
+	}
+	if (buffer.size() - 1 - end < CAPACITY / 2) buffer.resize(buffer.size() * 2);
+
+	long count = read_fd(fd, buffer.data() + end, (unsigned)(buffer.size() - 1 - end));
+	if (count <= 0) {
+		eof = true;
+		buffer[end] = '\0';
+		return false;
+	}
+
+	end += count;
+	buffer[end] = '\0';
+	return true;
+}
+void InputBuffer::ensure_number() {
+	// чтение не ждёт лишних данных : при вводе с терминала запись числа кончается не позже конца строки
+	std::size_t scanned = begin;
+	while (true) {
+		while (scanned < end && !is_delimiter((unsigned char)buffer[scanned])) scanned++;
+		if (scanned < end || scanned - begin >= MAX_NUMBER_LENGTH) return;
+
+		std::size_t offset = scanned - begin;
+		if (!fill()) return;
+		scanned = begin + offset;
+	}
+}
+
+int InputBuffer::peek() {
+	if (begin == end && !fill()) return -1;
+	return (unsigned char)buffer[begin];
+}
+void InputBuffer::skip_spaces() {
+	while (is_space(peek())) begin++;
+}
+
+bool InputBuffer::read_int(int& n) {
+	skip_spaces();
+	if (!isdigit(peek())) return false;
+
+	n = 0;
+	while (isdigit(peek())) {
+		n = n * 10 + (buffer[begin] - '0');
+		begin++;
+	}
+	return true;
+}
+
+bool InputBuffer::read_polynomial(Polynomial& polynomial) {
+	skip_spaces();
+	if (peek() != '[') return false;
+	begin++;
+
+	// термы копируются в многочлен как есть, в порядке записи (как в operator >>)
+	std::vector<int>   powers;
+	std::vector<float> coefficients;
+	while (true) {
+		skip_spaces();
+
+		int c = peek();
+		if (c == ']') {
+			begin++;
+			polynomial = Polynomial(powers.data(), coefficients.data(), powers.size());
+			return true;
+		}
+		if (c != '+' && c != '-') return false;
+		begin++;
+
+		// числа разбираются прямо из буфера : запись числа должна целиком лежать в нём
+		skip_spaces();
+		ensure_number();
+		char* number_end;
+		long power = std::strtol(buffer.data() + begin, &number_end, 10);
+		if (number_end == buffer.data() + begin || power < 0) return false;
+		begin = number_end - buffer.data();
+
+		skip_spaces();
+		if (peek() != ':') return false;
+		begin++;
+
+		skip_spaces();
+		ensure_number();
+		float coefficient = std::strtof(buffer.data() + begin, &number_end);
+		if (number_end == buffer.data() + begin) return false;
+		begin = number_end - buffer.data();
+
+		if (coefficient == 0) continue;
+
+		powers.push_back(power);
+		coefficients.push_back(c == '-' ? -coefficient : coefficient);
+	}
+}
+
+bool InputBuffer::read_record(std::string& record, char delimiter) {
+	record.clear();
+	while (true) {
+		// последняя запись может не заканчиваться разделителем
+		if (begin == end && !fill()) return !record.empty();
+
+		const char* start = buffer.data() + begin;
+		const char* found = (const char*)std::memchr(start, delimiter, end - begin);
+		if (found) {
+			record.append(start, found - start);
+			begin = found - buffer.data() + 1;
+			return true;
+		}
+
+		record.append(start, end - begin);
+		begin = end;
+	}
+}
+
+// ---------------------------------------
+// вывод
+// ---------------------------------------
+
+OutputBuffer::OutputBuffer(int _fd) : fd(_fd), target(nullptr), buffer(CAPACITY), size(0) {}
+
+OutputBuffer::~OutputBuffer() {
+	flush();
+}
+
+void OutputBuffer::bind(int _fd) {
+	flush();
+	fd = _fd;
+	target = nullptr;
+}
+void OutputBuffer::capture(std::string* _target) {
+	flush();
+	fd = -1;
+	target = _target;
+}
+
+void OutputBuffer::flush() {
+	if (size == 0) return;
+
+	if (fd < 0) {
+		if (target) target->append(buffer.data(), size);
+		size = 0;
+		return;
+	}
+
+	const char* data = buffer.data();
+	std::size_t left = size;
+	while (left > 0) {
+		long count = write_fd(fd, data, (unsigned)left);
+		if (count <= 0) break;
+
+		data += count;
+		left -= count;
+	}
+	size = 0;
+}
+
+void OutputBuffer::write(const char* data, std::size_t length) {
+	if (size + length > buffer.size()) {
+		flush();
+		if (length > buffer.size()) buffer.resize(length);
+	}
+
+	std::memcpy(buffer.data() + size, data, length);
+	size += length;
+}
+void OutputBuffer::write(const std::string& text) {
+	write(text.data(), text.size());
+}
+void OutputBuffer::write(char c) {
+	if (size == buffer.size()) flush();
+	buffer[size++] = c;
+}
+void OutputBuffer::write(int n) {
+	char digits[16];
+	int length = 0;
+
+	unsigned value = n < 0 ? 0u - (unsigned)n : (unsigned)n;
+	do {
+		digits[length++] = '0' + value % 10;
+		value /= 10;
+	} while (value);
+	if (n < 0) digits[length++] = '-';
+
+	char text[16];
+	for (int i = 0; i < length; i++) text[i] = digits[length - 1 - i];
+	write(text, length);
+}
+
+void OutputBuffer::write(const Polynomial& polynomial) {
+	write('[');
+
+	// коэффициенты печатаются как в std::ostream по умолчанию : %g с точностью 6
+	char text[64];
+	int polynomial_deg = polynomial.deg();
+	for (int pow = 0; pow <= polynomial_deg; pow++) {
+		float coeff = polynomial[pow];
+		if (coeff == 0) continue;
+
+		char sign;
+		if (coeff > 0) {
+			sign = '+';
+		}
+		else {
+			sign = '-';
+			coeff = -coeff;
+		}
+
+		write(sign);
+		write(pow);
+		write(" : ", 3);
+		write(text, std::snprintf(text, sizeof(text), "%g", coeff));
+
+		if (pow != polynomial_deg) write(' ');
+	}
+
+	write(']');
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "polynomial.hpp"
+
+/* буферизованный ввод и вывод интерпретатора
+*
+*  данные читаются и пишутся большими блоками прямо через дескрипторы файлов (read, write),
+*  без потоков iostream ; числа и многочлены разбираются прямо из буфера ввода
+*
+*  по умолчанию ввод --- дескриптор 0, вывод --- дескриптор 1 ; ввод можно взять из строки,
+*  а вывод --- собирать в строку (для запуска программы на заранее известных данных)
+*
+*  вывод записывается, когда буфер заполнен, при вызове flush и перед каждым чтением из дескриптора ввода
+*  (если буфер вывода связан с буфером ввода через tie), поэтому программа, ожидающая ввода, уже напечатала всё */
+class OutputBuffer;
+
+class InputBuffer {
+private:
+	int               fd;				// дескриптор ввода (-1 --- ввод из строки)
+	std::vector<char> buffer;			// прочитанные данные ; за последним байтом всегда стоит '\0'
+	std::size_t       begin;			// позиция следующего непрочитанного байта
+	std::size_t       end;				// конец прочитанных данных
+	bool              eof;				// данных больше не будет
+	OutputBuffer*     tied;				// вывод, который записывается перед чтением
+
+	// дочитать данные в буфер (непрочитанные байты переносятся в начало) ; false, если данных больше нет
+	bool fill();
+	// запись числа, которое начинается с позиции begin, целиком лежит в буфере (или это весь остаток ввода)
+	void ensure_number();
+public:
+	static const std::size_t CAPACITY = 1 << 16;
+
+	InputBuffer(int _fd = 0);
+
+	// привязка к дескриптору или к строке ; непрочитанные данные отбрасываются
+	void bind(int _fd);
+	void open_string(const std::string& text);
+	void tie(OutputBuffer* output);
+
+	// следующий байт без извлечения (-1 в конце ввода)
+	int peek();
+	void skip_spaces();
+
+	/* разбор значений (перед значением пропускаются пробелы) ;
+	*  false, если значение записано с ошибкой (прочитанные символы не возвращаются) */
+	bool read_int(int& n);
+	// формат многочлена тот же, что у operator >> : [+2 : 1.5 -0 : 3]
+	bool read_polynomial(Polynomial& polynomial);
+
+	// запись до разделителя (разделитель извлекается, но не входит в запись) ; false в конце ввода
+	bool read_record(std::string& record, char delimiter);
+};
+
+class OutputBuffer {
+private:
+	int               fd;				// дескриптор вывода (-1 --- вывод в строку)
+	std::string*      target;			// строка для вывода, если fd = -1
+	std::vector<char> buffer;
+	std::size_t       size;
+public:
+	static const std::size_t CAPACITY = 1 << 16;
+
+	OutputBuffer(int _fd = 1);
+	OutputBuffer(const OutputBuffer&) = delete;
+	OutputBuffer& operator =(const OutputBuffer&) = delete;
+	~OutputBuffer();
+
+	// привязка к дескриптору или к строке (nullptr --- вывод отбрасывается) ; накопленный вывод предварительно записывается
+	void bind(int _fd);
+	void capture(std::string* _target);
+
+	void write(const char* data, std::size_t length);
+	void write(const std::string& text);
+	void write(char c);
+	void write(int n);
+	// формат тот же, что у operator << для многочлена
+	void write(const Polynomial& polynomial);
+
+	// запись накопленного вывода
+	void flush();
+};
@@ -0,0 +1,1091 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "parser.cpp"
+#include "object.cpp"
+
+/* перечисление команд байт-кода
+*
+*  команда занимает одно слово кода, за которым следуют её операнды (тоже по слову) ;
+*  виды операндов каждой команды перечислены в Bytecode::operand_kinds :
+*      c    :    индекс константы в пуле констант
+*      s    :    номер ячейки переменной
+*      o    :    команда арифметической операции или сравнения (OpAdd ... OpBiggerOrEqual)
+*      t    :    смещение команды перехода в коде (уже найденное при компиляции)
+*  арифметические операции и сравнения --- отдельные команды
+*
+*  суперкоманды (после OpHalt) заменяют частые последовательности команд :
+*      OpPushVarVar       a b          :    push a, push b
+*      OpArithVarVar      a b op       :    push a, push b, op
+*      OpArithVarConst    a c op       :    push a, push c, op
+*      OpUpdateVarConst   a c op       :    push a, push c, op, pop a      (например, y = y + 1)
+*      OpJiCmpVarVar      a b op L     :    push a, push b, op, ji L
+*      OpJiCmpVarConst    a c op L     :    push a, push c, op, ji L
+*      OpJiCmpConst       c op L       :    push c, op, ji L
+*
+*  команды для операндов, тип которых известен при компиляции (см. Compiler::specialize) :
+*      OpIntArith, OpIntCompare         op    :    арифметика и сравнение двух чисел на вершине стека
+*      OpPolyArith                      op    :    арифметика двух многочленов на вершине стека
+*      OpIntArithVarVar ... OpIntJiCmpConst   :    суперкоманды, все операнды которых --- числа
+*  такие команды не проверяют типы операндов */
+enum OpCode { OpPush, OpPushVar, OpPop, OpJmp, OpJi, OpRead, OpWrite, OpEnd,
+			  OpAdd, OpSub, OpMul, OpDiv, OpMod,
+			  OpEqual, OpNotEqual, OpLess, OpLessOrEqual, OpBigger, OpBiggerOrEqual,
+			  OpAtpow, OpDeg, OpDerivative, OpValue, OpMVar, OpRoots, OpDerivN, OpShift,
+			  OpFail,								// ошибка во время выполнения (переход на несуществующую строку)
+			  OpHalt,								// остановка : сюда переходят end и ошибки
+
+			  OpPushVarVar, OpArithVarVar, OpArithVarConst, OpUpdateVarConst,
+			  OpJiCmpVarVar, OpJiCmpVarConst, OpJiCmpConst,
+
+			  OpIntArith, OpIntCompare, OpPolyArith,
+			  OpIntArithVarVar, OpIntArithVarConst, OpIntUpdateVarConst,
+			  OpIntJiCmpVarVar, OpIntJiCmpVarConst, OpIntJiCmpConst,
+			  COUNT_OPCODES
+			};
+
+bool is_arithmetic(OpCode op) {
+	return op >= OpAdd && op <= OpMod;
+}
+bool is_comparison(OpCode op) {
+	return op >= OpEqual && op <= OpBiggerOrEqual;
+}
+
+/* арифметическая операция (OpAdd ... OpMod) над объектами ;
+*  исключение выбрасывается, если операция не определена для операндов */
+Object apply_arithmetic(OpCode op, const Object& obj1, const Object& obj2) {
+	switch (op) {
+	case OpAdd: return obj1 + obj2;
+	case OpSub: return obj1 - obj2;
+	case OpMul: return obj1 * obj2;
+	case OpDiv: return obj1 / obj2;
+	case OpMod: return obj1 % obj2;
+	default:    throw 1;
+	}
+}
+/* сравнение (OpEqual ... OpBiggerOrEqual) объектов ; исключение выбрасывается, если объекты нельзя сравнить */
+bool apply_comparison(OpCode op, const Object& obj1, const Object& obj2) {
+	switch (op) {
+	case OpEqual:         return obj1 == obj2;
+	case OpNotEqual:      return obj1 != obj2;
+	case OpLess:          return obj1 <  obj2;
+	case OpLessOrEqual:   return obj1 <= obj2;
+	case OpBigger:        return obj1 >  obj2;
+	case OpBiggerOrEqual: return obj1 >= obj2;
+	default:              throw 1;
+	}
+}
+
+/* арифметические операции и сравнения над числами и над многочленами (для команд, типы операндов которых
+*  известны при компиляции) ; деление чисел на ноль, как и в общих операциях, выбрасывает исключение */
+inline int int_arithmetic(OpCode op, int a, int b) {
+	switch (op) {
+	case OpAdd: return a + b;
+	case OpSub: return a - b;
+	case OpMul: return a * b;
+	case OpDiv: return int_divide(a, b);
+	case OpMod: return int_modulo(a, b);
+	default:    return 0;
+	}
+}
+inline bool int_comparison(OpCode op, int a, int b) {
+	switch (op) {
+	case OpEqual:         return a == b;
+	case OpNotEqual:      return a != b;
+	case OpLess:          return a <  b;
+	case OpLessOrEqual:   return a <= b;
+	case OpBigger:        return a >  b;
+	case OpBiggerOrEqual: return a >= b;
+	default:              return false;
+	}
+}
+inline Polynomial polynomial_arithmetic(OpCode op, const Polynomial& a, const Polynomial& b) {
+	switch (op) {
+	case OpAdd: return a + b;
+	case OpSub: return a - b;
+	case OpMul: return a * b;
+	case OpDiv: return a / b;
+	case OpMod: return a % b;
+	default:    return Polynomial();
+	}
+}
+
+/* функции над многочленами : OpDeg, OpDerivative, OpMVar (один операнд --- вершина стека) ;
+*  исключение выбрасывается, если функция не определена для операнда */
+Object apply_function(OpCode op, const Object& obj) {
+	Polynomial buffer;
+	switch (op) {
+	case OpDeg:
+		switch (obj.get_type()) {
+		case ValueType::Integer:      return Object(0);
+		case ValueType::Polynomial:   return Object(obj.get_polynomial().deg());
+		case ValueType::Multivariate: return Object(obj.get_multivariate().deg());
+		default:                      throw 1;
+		}
+	case OpDerivative:
+		if (obj.get_type() == ValueType::Multivariate) throw 1;
+		return Object(obj.as_polynomial(buffer).derivative());
+	case OpMVar:
+		// заменить номер переменной i многочленом xi
+		if (obj.get_type() != ValueType::Integer) throw 1;
+		if (obj.get_int() < 0 || obj.get_int() >= MultiPolynomial::MAX_VARIABLES) throw 1;
+		return Object(MultiPolynomial::variable(obj.get_int()));
+	default:
+		throw 1;
+	}
+}
+/* функции над многочленами : OpAtpow, OpValue, OpDerivN, OpShift ;
+*  obj1 --- многочлен (под вершиной стека), obj2 --- параметр (на вершине стека) :
+*      atpow     :    коэффициент при степени obj2
+*      value     :    значение в точке obj2
+*      derivn    :    производная порядка obj2
+*      shift     :    многочлен P(x + a), a --- число или многочлен нулевой степени */
+Object apply_function(OpCode op, const Object& obj1, const Object& obj2) {
+	if (obj1.get_type() == ValueType::Multivariate || obj2.get_type() == ValueType::Multivariate) throw 1;
+
+	Polynomial buffer1, buffer2;
+	switch (op) {
+	case OpAtpow:
+		if (obj2.get_type() != ValueType::Integer) throw 1;
+		return Object((int)obj1.as_polynomial(buffer1)[obj2.get_int()]);
+	case OpValue:
+		if (obj2.get_type() != ValueType::Integer) throw 1;
+		return Object(Polynomial(obj1.as_polynomial(buffer1)(obj2.get_int())));
+	case OpDerivN:
+		if (obj2.get_type() != ValueType::Integer) throw 1;
+		return Object(obj1.as_polynomial(buffer1).derivative(obj2.get_int()));
+	case OpShift:
+		if (obj2.get_type() == ValueType::Polynomial && obj2.get_polynomial().deg() != 0) throw 1;
+		return Object(obj1.as_polynomial(buffer1).taylor_shift(obj2.as_polynomial(buffer2)[0]));
+	default:
+		throw 1;
+	}
+}
+
+/* класс "байт-код" : результат компиляции программы
+*
+*  code  :    команды с операндами подряд ; переход --- это присваивание смещения
+*  lines :    номер строки исходного файла для каждого слова кода (для сообщений и отладки)
+*
+*  переменные пронумерованы при компиляции : значения хранятся в массиве ячеек,
+*  slot_names[i] --- имя переменной в ячейке i
+*
+*  константы программы создаются один раз при компиляции и хранятся в пуле constants ;
+*  push константы только копирует объект из пула : число копируется целиком,
+*  у многочлена увеличивается счётчик ссылок (значения объектов не изменяются)
+*
+*  halt_offset --- смещение команды OpHalt, на которую переходят end и ошибки */
+class Bytecode {
+public:
+	std::vector<int> code;
+	std::vector<int> lines;
+	int              halt_offset = 0;
+
+	std::vector<std::string> slot_names;
+	std::vector<Object>      constants;
+
+	// виды операндов команды (см. OpCode)
+	static const char* operand_kinds(OpCode op) {
+		static const char* kinds[COUNT_OPCODES] = {
+			"c", "s", "s", "t", "t", "", "", "",
+			"", "", "", "", "",
+			"", "", "", "", "", "",
+			"", "", "", "", "", "", "", "",
+			"", "",
+			"ss", "sso", "sco", "sco",
+			"ssot", "scot", "cot",
+			"o", "o", "o",
+			"sso", "sco", "sco",
+			"ssot", "scot", "cot"
+		};
+		return kinds[op];
+	}
+
+	// длина команды вместе с операндами (в словах) : 1 + количество видов операндов
+	static int length(OpCode op) {
+		static const unsigned char lengths[COUNT_OPCODES] = {
+			2, 2, 2, 2, 2, 1, 1, 1,
+			1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1, 1, 1,
+			1, 1,
+			3, 4, 4, 4,
+			5, 5, 4,
+			2, 2, 2,
+			4, 4, 4,
+			5, 5, 4
+		};
+		return lengths[op];
+	}
+
+	/* действие команды на стек : сколько объектов нужно на вершине стека и сколько их остаётся вместо них
+	*  (roots оставляет заранее неизвестное количество, -1) */
+	static int stack_inputs(OpCode op) {
+		static const signed char inputs[COUNT_OPCODES] = {
+			0, 0, 1, 0, 1, 0, 1, 0,
+			2, 2, 2, 2, 2,
+			2, 2, 2, 2, 2, 2,
+			2, 1, 1, 2, 1, 1, 2, 2,
+			0, 0,
+			0, 0, 0, 0,
+			0, 0, 1,
+			2, 2, 2,
+			0, 0, 0,
+			0, 0, 1
+		};
+		return inputs[op];
+	}
+	static int stack_outputs(OpCode op) {
+		static const signed char outputs[COUNT_OPCODES] = {
+			1, 1, 0, 0, 0, 1, 0, 0,
+			1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, 1,
+			1, 1, 1, 1, 1, -1, 1, 1,
+			0, 0,
+			2, 1, 1, 0,
+			0, 0, 0,
+			1, 1, 1,
+			1, 1, 0,
+			0, 0, 0
+		};
+		return outputs[op];
+	}
+
+	static const char* name(OpCode op) {
+		static const char* names[COUNT_OPCODES] = {
+			"push", "push", "pop", "jmp", "ji", "read", "write", "end",
+			"+", "-", "*", "/", "%",
+			"=", "!=", "<", "<=", ">", ">=",
+			"atpow", "deg", "derivative", "value", "mvar", "roots", "derivn", "shift",
+			"fail", "halt",
+			"push_var_var", "arith_var_var", "arith_var_const", "update_var_const",
+			"ji_cmp_var_var", "ji_cmp_var_const", "ji_cmp_const",
+			"int_arith", "int_compare", "poly_arith",
+			"int_arith_var_var", "int_arith_var_const", "int_update_var_const",
+			"int_ji_cmp_var_var", "int_ji_cmp_var_const", "int_ji_cmp_const"
+		};
+		return names[op];
+	}
+
+	void emit(OpCode op, int line) {
+		code.push_back(op);
+		lines.push_back(line);
+	}
+	void emit(OpCode op, int operand, int line) {
+		emit(op, line);
+		code.push_back(operand);
+		lines.push_back(line);
+	}
+
+	/* смещение команды, с которой начинается строка line исходного файла ; -1, если такой команды нет
+	*  (строка не исполняется, удалена оптимизацией или слита с предыдущей строкой в суперкоманду) */
+	int line_offset(int line) const {
+		int previous_line = -1;
+		for (int offset = 0; offset < code.size(); offset += length((OpCode)code[offset])) {
+			if (lines[offset] == line && previous_line != line) return offset;
+			previous_line = lines[offset];
+		}
+		return -1;
+	}
+
+	/* вывод листинга : смещение, строка исходного файла, команда и операнды
+	*  (константы --- значениями, переменные --- именами) */
+	void print(std::ostream& stream = std::cout) const {
+		for (int offset = 0; offset < code.size(); offset += length((OpCode)code[offset])) {
+			OpCode op = (OpCode)code[offset];
+
+			stream.width(4); stream << offset << "  ";
+			stream.width(3); stream << lines[offset] << ": " << name(op);
+
+			const char* kinds = operand_kinds(op);
+			for (int i = 0; kinds[i]; i++) {
+				int operand = code[offset + 1 + i];
+				switch (kinds[i]) {
+				case 'c': stream << ' ' << operand << " (Константа: "  << constants[operand]  << ')'; break;
+				case 's': stream << ' ' << operand << " (Переменная: " << slot_names[operand] << ')'; break;
+				case 'o': stream << ' ' << name((OpCode)operand); break;
+				case 't': stream << " -> " << operand; break;
+				}
+			}
+			stream << '\n';
+		}
+	}
+};
+
+/* команда байт-кода в разобранном виде (для преобразований кода компилятором) ;
+*  операнд-переход хранит номер команды, а не смещение */
+struct Instruction {
+	OpCode op;
+	int    operands[4];
+	int    line;
+	bool   jump_target;		// на команду есть переход
+};
+
+/* тип значения, известный при компиляции ; Unknown --- любой (в том числе значение неинициализированной переменной) */
+enum class StaticType { Integer, Polynomial, Multivariate, Unknown };
+
+StaticType join(StaticType a, StaticType b) {
+	return a == b ? a : StaticType::Unknown;
+}
+
+/* типы значений перед командой : типы объектов в стеке (если глубина стека одинакова на всех путях к команде)
+*  и типы значений переменных */
+struct TypeState {
+	bool                    reached = false;	// команда достижима
+	bool                    stack_known = true;
+	std::vector<StaticType> stack;
+	std::vector<StaticType> variables;
+
+	void push(StaticType type) {
+		if (stack_known) stack.push_back(type);
+	}
+	StaticType pop() {
+		if (!stack_known || stack.empty()) return StaticType::Unknown;
+
+		StaticType type = stack.back();
+		stack.pop_back();
+		return type;
+	}
+	// тип объекта на глубине depth от вершины стека
+	StaticType top(int depth = 0) const {
+		if (!stack_known || depth >= stack.size()) return StaticType::Unknown;
+		return stack[stack.size() - 1 - depth];
+	}
+
+	// объединение с состоянием, пришедшим по другому пути ; возвращает true, если состояние изменилось
+	bool merge(const TypeState& other) {
+		if (!reached) {
+			*this = other;
+			reached = true;
+			return true;
+		}
+
+		bool changed = false;
+		for (int slot = 0; slot < variables.size(); slot++) {
+			StaticType type = join(variables[slot], other.variables[slot]);
+			if (type != variables[slot]) { variables[slot] = type; changed = true; }
+		}
+
+		if (!stack_known) return changed;
+		if (!other.stack_known || other.stack.size() != stack.size()) {
+			stack_known = false;
+			stack.clear();
+			return true;
+		}
+		for (int i = 0; i < stack.size(); i++) {
+			StaticType type = join(stack[i], other.stack[i]);
+			if (type != stack[i]) { stack[i] = type; changed = true; }
+		}
+		return changed;
+	}
+};
+
+/* параметры компиляции одним числом (записываются в трассу и в кэш скомпилированной программы) */
+enum CompileFlags { CompileFused = 1, CompileOptimized = 2, CompileSpecialized = 4 };
+
+int compile_flags(bool fuse_sequences, bool optimize_code, bool specialize_types) {
+	return (fuse_sequences ? CompileFused : 0) | (optimize_code ? CompileOptimized : 0) | (specialize_types ? CompileSpecialized : 0);
+}
+
+/* класс "компилятор" : переводит лексемы обработанной программы в байт-код
+*
+*  комментарии и ошибки в код не попадают (программа с ошибками не интерпретируется) ;
+*  каждой переменной таблицы имён назначается ячейка, каждой константе --- место в пуле констант
+*  (в порядке первого появления в программе) ;
+*  номер строки в jmp и ji заменяется смещением первой команды этой строки, поэтому переход
+*  во время выполнения не требует поиска ; переход на строку без лексем ведёт на команду OpFail
+*
+*  если optimize_code = true, код проходит оптимизацию (см. optimize) ;
+*  если fuse_sequences = true, частые последовательности команд заменяются суперкомандами ;
+*  последовательность заменяется, только если внутрь неё (кроме первой команды) нет переходов ;
+*  если specialize_types = true, команды, типы операндов которых известны, заменяются командами
+*  для чисел и многочленов (см. specialize) */
+class Compiler {
+private:
+	static int jump_operand(OpCode op) {
+		const char* found = std::strchr(Bytecode::operand_kinds(op), 't');
+		return found ? found - Bytecode::operand_kinds(op) : -1;
+	}
+
+	// разбор кода на команды ; операнды-переходы заменяются номерами команд
+	static std::vector<Instruction> decode(const Bytecode& bytecode) {
+		std::vector<Instruction> instructions;
+		std::map<int, int> index_of_offset;
+
+		for (int offset = 0; offset < bytecode.code.size(); offset += Bytecode::length((OpCode)bytecode.code[offset])) {
+			Instruction instruction = {};
+			instruction.op = (OpCode)bytecode.code[offset];
+			instruction.line = bytecode.lines[offset];
+			for (int i = 1; i < Bytecode::length(instruction.op); i++) {
+				instruction.operands[i - 1] = bytecode.code[offset + i];
+			}
+
+			index_of_offset[offset] = instructions.size();
+			instructions.push_back(instruction);
+		}
+
+		for (Instruction& instruction : instructions) {
+			int jump = jump_operand(instruction.op);
+			if (jump < 0) continue;
+
+			instruction.operands[jump] = index_of_offset[instruction.operands[jump]];
+			instructions[instruction.operands[jump]].jump_target = true;
+		}
+
+		return instructions;
+	}
+	// обратная сборка кода
+	static void encode(const std::vector<Instruction>& instructions, Bytecode& bytecode) {
+		std::vector<int> offset_of_index(instructions.size());
+		int offset = 0;
+		for (int index = 0; index < instructions.size(); index++) {
+			offset_of_index[index] = offset;
+			offset += Bytecode::length(instructions[index].op);
+		}
+
+		bytecode.code.clear();
+		bytecode.lines.clear();
+		for (const Instruction& instruction : instructions) {
+			if (instruction.op == OpHalt) bytecode.halt_offset = bytecode.code.size();
+
+			bytecode.emit(instruction.op, instruction.line);
+
+			int jump = jump_operand(instruction.op);
+			for (int i = 0; i < Bytecode::length(instruction.op) - 1; i++) {
+				bytecode.code.push_back(i == jump ? offset_of_index[instruction.operands[i]] : instruction.operands[i]);
+				bytecode.lines.push_back(instruction.line);
+			}
+		}
+	}
+
+	static void mark_jump_targets(std::vector<Instruction>& instructions) {
+		for (Instruction& instruction : instructions) instruction.jump_target = false;
+
+		for (Instruction& instruction : instructions) {
+			int jump = jump_operand(instruction.op);
+			if (jump >= 0) instructions[instruction.operands[jump]].jump_target = true;
+		}
+	}
+
+	/* удаление отмеченных команд ; переход на удалённую команду ведёт на следующую оставшуюся
+	*  (последняя команда OpHalt не удаляется никогда) */
+	static void remove_instructions(std::vector<Instruction>& instructions, const std::vector<bool>& removed) {
+		std::vector<Instruction> kept;
+		std::vector<int> new_index(instructions.size());
+		for (int index = 0; index < instructions.size(); index++) {
+			new_index[index] = kept.size();
+			if (!removed[index]) kept.push_back(instructions[index]);
+		}
+
+		for (Instruction& instruction : kept) {
+			int jump = jump_operand(instruction.op);
+			if (jump >= 0) instruction.operands[jump] = new_index[instruction.operands[jump]];
+		}
+
+		instructions = std::move(kept);
+		mark_jump_targets(instructions);
+	}
+
+	// номера команд, которые могут исполняться после данной
+	static std::vector<int> successors(const std::vector<Instruction>& instructions, int index) {
+		const Instruction& instruction = instructions[index];
+		switch (instruction.op) {
+		case OpEnd: case OpFail: case OpHalt: return {};
+		case OpJmp:                           return { instruction.operands[0] };
+		default: break;
+		}
+
+		int jump = jump_operand(instruction.op);
+		if (jump >= 0) return { index + 1, instruction.operands[jump] };
+		return { index + 1 };
+	}
+
+	/* ячейки, которым заведомо присвоено значение перед исполнением каждой команды
+	*  (по всем путям из начала программы) ; для недостижимой команды --- пустой вектор */
+	static std::vector<std::vector<bool>> assigned_slots(const std::vector<Instruction>& instructions, int count_slots) {
+		std::vector<std::vector<bool>> assigned(instructions.size());
+		std::vector<bool> reached(instructions.size(), false);
+		std::vector<int> worklist = { 0 };
+		assigned[0].assign(count_slots, false);
+		reached[0] = true;
+
+		while (!worklist.empty()) {
+			int index = worklist.back();
+			worklist.pop_back();
+
+			std::vector<bool> after = assigned[index];
+			if (instructions[index].op == OpPop) after[instructions[index].operands[0]] = true;
+
+			for (int next : successors(instructions, index)) {
+				if (!reached[next]) {
+					reached[next] = true;
+					assigned[next] = after;
+					worklist.push_back(next);
+					continue;
+				}
+
+				// в точке слияния путей присвоены только ячейки, присвоенные на всех путях
+				bool changed = false;
+				for (int slot = 0; slot < count_slots; slot++) {
+					if (assigned[next][slot] && !after[slot]) { assigned[next][slot] = false; changed = true; }
+				}
+				if (changed) worklist.push_back(next);
+			}
+		}
+
+		return assigned;
+	}
+
+	/* свёртка констант и удаление лишних команд (один проход ; возвращает true, если код изменился) :
+	*      push c1, push c2, op    ->    push (c1 op c2)      арифметика, сравнения, atpow, value, derivn, shift
+	*      push c, op              ->    push op(c)           deg, derivative, mvar
+	*      push c, ji L            ->    jmp L или ничего      (в зависимости от истинности c)
+	*      push x, pop x           ->    ничего               если переменной x заведомо присвоено значение
+	*  вычисление, которое закончилось бы ошибкой (или деление на ноль), не сворачивается :
+	*  ошибка произойдёт во время выполнения, как и без оптимизации ;
+	*  внутрь сворачиваемой последовательности (кроме первой команды) не должно быть переходов */
+	static bool fold_constants(std::vector<Instruction>& instructions, Bytecode& bytecode) {
+		std::vector<std::vector<bool>> assigned = assigned_slots(instructions, bytecode.slot_names.size());
+		std::vector<bool> removed(instructions.size(), false);
+		bool changed = false;
+
+		auto push_constant = [&](Instruction& instruction, Object&& value) {
+			instruction.op = OpPush;
+			instruction.operands[0] = bytecode.constants.size();
+			bytecode.constants.push_back(std::move(value));
+		};
+
+		for (int index = 0; index + 1 < instructions.size(); index++) {
+			Instruction& first  = instructions[index];
+			Instruction& second = instructions[index + 1];
+			if (second.jump_target) continue;
+
+			if (first.op == OpPushVar && second.op == OpPop && first.operands[0] == second.operands[0]
+				&& assigned[index].size() > first.operands[0] && assigned[index][first.operands[0]]) {
+				removed[index] = removed[index + 1] = true;
+				changed = true;
+				index++;
+				continue;
+			}
+
+			if (first.op != OpPush) continue;
+			const Object& obj = bytecode.constants[first.operands[0]];
+
+			if (second.op == OpJi) {
+				if (obj.truth()) first = { OpJmp, { second.operands[0] }, first.line, first.jump_target };
+				else             removed[index] = true;
+				removed[index + 1] = true;
+				changed = true;
+				index++;
+				continue;
+			}
+
+			if (second.op == OpDeg || second.op == OpDerivative || second.op == OpMVar) {
+				try {
+					push_constant(first, apply_function(second.op, obj));
+					removed[index + 1] = true;
+					changed = true;
+					index++;
+				}
+				catch (...) {}
+				continue;
+			}
+
+			if (index + 2 >= instructions.size()) continue;
+			Instruction& third = instructions[index + 2];
+			if (second.op != OpPush || third.jump_target) continue;
+
+			const Object& obj2 = bytecode.constants[second.operands[0]];
+			if ((third.op == OpDiv || third.op == OpMod) && !obj2.truth()) continue;
+
+			try {
+				if      (is_arithmetic(third.op)) push_constant(first, apply_arithmetic(third.op, obj, obj2));
+				else if (is_comparison(third.op)) push_constant(first, Object(apply_comparison(third.op, obj, obj2)));
+				else if (third.op == OpAtpow || third.op == OpValue || third.op == OpDerivN || third.op == OpShift) {
+					push_constant(first, apply_function(third.op, obj, obj2));
+				}
+				else continue;
+
+				removed[index + 1] = removed[index + 2] = true;
+				changed = true;
+				index += 2;
+			}
+			catch (...) {}
+		}
+
+		if (changed) remove_instructions(instructions, removed);
+		return changed;
+	}
+
+	/* сокращение цепочек переходов (один проход ; возвращает true, если код изменился) :
+	*      переход на jmp L       ->    переход на L
+	*      jmp на end             ->    end
+	*      jmp на следующую команду удаляется */
+	static bool thread_jumps(std::vector<Instruction>& instructions) {
+		std::vector<bool> removed(instructions.size(), false);
+		bool changed = false;
+
+		for (int index = 0; index < instructions.size(); index++) {
+			Instruction& instruction = instructions[index];
+			int jump = jump_operand(instruction.op);
+			if (jump < 0) continue;
+
+			// цепочка jmp ; длина ограничена, чтобы не зациклиться на бесконечном цикле из jmp
+			int target = instruction.operands[jump];
+			for (int step = 0; step < instructions.size() && instructions[target].op == OpJmp && instructions[target].operands[0] != target; step++) {
+				target = instructions[target].operands[0];
+			}
+			if (target != instruction.operands[jump]) {
+				instruction.operands[jump] = target;
+				changed = true;
+			}
+
+			if (instruction.op != OpJmp) continue;
+
+			if (instructions[target].op == OpEnd) {
+				instruction.op = OpEnd;
+				changed = true;
+			}
+			else if (target == index + 1) {
+				removed[index] = true;
+				changed = true;
+			}
+		}
+
+		if (changed) remove_instructions(instructions, removed);
+		return changed;
+	}
+
+	// удаление команд, недостижимых из начала программы (например, после end)
+	static bool remove_unreachable(std::vector<Instruction>& instructions) {
+		std::vector<bool> reachable(instructions.size(), false);
+		std::vector<int> worklist = { 0 };
+		reachable[0] = true;
+		while (!worklist.empty()) {
+			int index = worklist.back();
+			worklist.pop_back();
+
+			for (int next : successors(instructions, index)) {
+				if (!reachable[next]) { reachable[next] = true; worklist.push_back(next); }
+			}
+		}
+
+		std::vector<bool> removed(instructions.size(), false);
+		bool changed = false;
+		for (int index = 0; index < instructions.size(); index++) {
+			if (reachable[index] || instructions[index].op == OpHalt) continue;
+
+			removed[index] = true;
+			changed = true;
+		}
+
+		if (changed) remove_instructions(instructions, removed);
+		return changed;
+	}
+
+	// пул констант без констант, на которые не осталось ссылок
+	static void compact_constants(std::vector<Instruction>& instructions, Bytecode& bytecode) {
+		std::vector<Object> constants;
+		std::vector<int> new_index(bytecode.constants.size(), -1);
+
+		for (Instruction& instruction : instructions) {
+			if (instruction.op != OpPush) continue;
+
+			int& constant = instruction.operands[0];
+			if (new_index[constant] < 0) {
+				new_index[constant] = constants.size();
+				constants.push_back(bytecode.constants[constant]);
+			}
+			constant = new_index[constant];
+		}
+
+		bytecode.constants = std::move(constants);
+	}
+
+	/* оптимизация кода : свёртка констант, сокращение цепочек переходов, удаление недостижимого кода ;
+	*  преобразования повторяются, пока код меняется (свёртка может открыть новые возможности) */
+	static void optimize(Bytecode& bytecode) {
+		std::vector<Instruction> instructions = decode(bytecode);
+
+		// недостижимый код удаляется до свёртки : её вычисления не нужны и не должны выполняться для такого кода
+		bool changed = true;
+		while (changed) {
+			changed = remove_unreachable(instructions);
+			changed = fold_constants(instructions, bytecode) || changed;
+			changed = thread_jumps(instructions) || changed;
+		}
+
+		compact_constants(instructions, bytecode);
+		encode(instructions, bytecode);
+	}
+
+	// образец суперкоманды : последовательность команд (OpAdd означает любую арифметическую операцию, OpEqual --- любое сравнение)
+	struct FusionPattern {
+		OpCode              fused;
+		std::vector<OpCode> sequence;
+	};
+
+	static bool matches(const std::vector<Instruction>& instructions, int first, const FusionPattern& pattern) {
+		if (first + pattern.sequence.size() > instructions.size()) return false;
+
+		for (int i = 0; i < pattern.sequence.size(); i++) {
+			const Instruction& instruction = instructions[first + i];
+			if (i > 0 && instruction.jump_target) return false;
+
+			switch (pattern.sequence[i]) {
+			case OpAdd:   if (!is_arithmetic(instruction.op)) return false; break;
+			case OpEqual: if (!is_comparison(instruction.op)) return false; break;
+			default:      if (instruction.op != pattern.sequence[i]) return false;
+			}
+		}
+
+		// y = y + c : push и pop одной и той же переменной
+		if (pattern.fused == OpUpdateVarConst && instructions[first].operands[0] != instructions[first + 3].operands[0]) return false;
+
+		return true;
+	}
+
+	/* суперкоманда из команд instructions[first ...] : операнды берутся по порядку
+	*  (операнды push, затем сама операция, затем операнд ji) */
+	static Instruction fuse_instructions(const std::vector<Instruction>& instructions, int first, const FusionPattern& pattern) {
+		Instruction fused = instructions[first];
+		fused.op = pattern.fused;
+
+		int count_operands = 0;
+		for (int i = 0; i < pattern.sequence.size(); i++) {
+			const Instruction& instruction = instructions[first + i];
+			switch (instruction.op) {
+			case OpPush: case OpPushVar: fused.operands[count_operands++] = instruction.operands[0]; break;
+			case OpJi:                   fused.operands[count_operands++] = instruction.operands[0]; break;
+			case OpPop:                  break;
+			default:                     fused.operands[count_operands++] = instruction.op;
+			}
+		}
+
+		return fused;
+	}
+
+	static void fuse(Bytecode& bytecode) {
+		// более длинные образцы проверяются первыми
+		static const FusionPattern patterns[] = {
+			{ OpUpdateVarConst, { OpPushVar, OpPush,    OpAdd,   OpPop } },
+			{ OpJiCmpVarVar,    { OpPushVar, OpPushVar, OpEqual, OpJi  } },
+			{ OpJiCmpVarConst,  { OpPushVar, OpPush,    OpEqual, OpJi  } },
+			{ OpArithVarVar,    { OpPushVar, OpPushVar, OpAdd } },
+			{ OpArithVarConst,  { OpPushVar, OpPush,    OpAdd } },
+			{ OpJiCmpConst,     { OpPush,    OpEqual,   OpJi  } },
+			{ OpPushVarVar,     { OpPushVar, OpPushVar } },
+		};
+
+		std::vector<Instruction> instructions = decode(bytecode);
+
+		std::vector<Instruction> fused;
+		std::vector<int> new_index(instructions.size());
+		for (int index = 0; index < instructions.size(); ) {
+			const FusionPattern* found = nullptr;
+			for (const FusionPattern& pattern : patterns) {
+				if (matches(instructions, index, pattern)) { found = &pattern; break; }
+			}
+
+			new_index[index] = fused.size();
+			if (!found) {
+				fused.push_back(instructions[index]);
+				index++;
+				continue;
+			}
+
+			fused.push_back(fuse_instructions(instructions, index, *found));
+			index += found->sequence.size();
+		}
+
+		// переходы ведут только на первые команды последовательностей, поэтому номера пересчитываются
+		for (Instruction& instruction : fused) {
+			int jump = jump_operand(instruction.op);
+			if (jump >= 0) instruction.operands[jump] = new_index[instruction.operands[jump]];
+		}
+
+		encode(fused, bytecode);
+	}
+	static StaticType constant_type(const Object& constant) {
+		switch (constant.get_type()) {
+		case ValueType::Integer:      return StaticType::Integer;
+		case ValueType::Polynomial:   return StaticType::Polynomial;
+		case ValueType::Multivariate: return StaticType::Multivariate;
+		default:                      return StaticType::Unknown;
+		}
+	}
+	// тип результата арифметической операции (см. CALCULATE в object.cpp)
+	static StaticType arithmetic_type(StaticType a, StaticType b) {
+		if (a == StaticType::Integer && b == StaticType::Integer)           return StaticType::Integer;
+		if (a == StaticType::Unknown || b == StaticType::Unknown)           return StaticType::Unknown;
+		if (a == StaticType::Multivariate || b == StaticType::Multivariate) return StaticType::Multivariate;
+		return StaticType::Polynomial;
+	}
+	// сравнения <, <=, >, >= определены только для чисел
+	static bool is_ordering(int op) {
+		return op >= OpLess && op <= OpBiggerOrEqual;
+	}
+
+	/* изменение типов командой : state --- состояние перед командой, после вызова --- после неё
+	*
+	*  если команда не может закончиться успешно для операндов другого типа, после неё тип операндов известен :
+	*  после сравнения переменных операцией <, <=, >, >= (и перехода или не перехода) обе переменные --- числа */
+	static void transfer(const Instruction& instruction, const Bytecode& bytecode, TypeState& state) {
+		auto variable = [&](int operand) -> StaticType& { return state.variables[instruction.operands[operand]]; };
+		auto constant = [&](int operand) { return constant_type(bytecode.constants[instruction.operands[operand]]); };
+
+		switch (instruction.op) {
+		case OpPush:    state.push(constant(0)); break;
+		case OpPushVar: state.push(variable(0)); break;
+		case OpPop:     variable(0) = state.pop(); break;
+		case OpJi:
+		case OpWrite:   state.pop(); break;
+		case OpRead:    state.push(StaticType::Unknown); break;
+
+		case OpAdd: case OpSub: case OpMul: case OpDiv: case OpMod:
+		case OpIntArith: case OpPolyArith: {
+			StaticType b = state.pop();
+			StaticType a = state.pop();
+			state.push(arithmetic_type(a, b));
+			break;
+		}
+		case OpEqual: case OpNotEqual: case OpLess: case OpLessOrEqual: case OpBigger: case OpBiggerOrEqual:
+		case OpIntCompare:
+		case OpAtpow:
+			state.pop();
+			state.pop();
+			state.push(StaticType::Integer);
+			break;
+
+		case OpDeg:        state.pop(); state.push(StaticType::Integer);      break;
+		case OpDerivative: state.pop(); state.push(StaticType::Polynomial);   break;
+		case OpMVar:       state.pop(); state.push(StaticType::Multivariate); break;
+		case OpValue:
+		case OpDerivN:
+		case OpShift:
+			state.pop();
+			state.pop();
+			state.push(StaticType::Polynomial);
+			break;
+		case OpRoots:
+			// количество объектов в стеке после roots неизвестно
+			state.stack_known = false;
+			state.stack.clear();
+			break;
+
+		case OpPushVarVar:
+			state.push(variable(0));
+			state.push(variable(1));
+			break;
+		case OpArithVarVar:     case OpIntArithVarVar:     state.push(arithmetic_type(variable(0), variable(1))); break;
+		case OpArithVarConst:   case OpIntArithVarConst:   state.push(arithmetic_type(variable(0), constant(1))); break;
+		case OpUpdateVarConst:  case OpIntUpdateVarConst:  variable(0) = arithmetic_type(variable(0), constant(1)); break;
+		case OpJiCmpVarVar:     case OpIntJiCmpVarVar:
+			if (is_ordering(instruction.operands[2])) variable(0) = variable(1) = StaticType::Integer;
+			break;
+		case OpJiCmpVarConst:   case OpIntJiCmpVarConst:
+			if (is_ordering(instruction.operands[2])) variable(0) = StaticType::Integer;
+			break;
+		case OpJiCmpConst:      case OpIntJiCmpConst:      state.pop(); break;
+
+		default: break;
+		}
+	}
+
+	// типы перед каждой командой (обход графа переходов от первой команды до неподвижной точки)
+	static std::vector<TypeState> infer_types(const std::vector<Instruction>& instructions, const Bytecode& bytecode) {
+		std::vector<TypeState> states(instructions.size());
+		states[0].reached = true;
+		states[0].variables.assign(bytecode.slot_names.size(), StaticType::Unknown);
+
+		std::vector<int> worklist = { 0 };
+		while (!worklist.empty()) {
+			int index = worklist.back();
+			worklist.pop_back();
+
+			TypeState after = states[index];
+			transfer(instructions[index], bytecode, after);
+
+			for (int next : successors(instructions, index)) {
+				if (states[next].merge(after)) worklist.push_back(next);
+			}
+		}
+
+		return states;
+	}
+
+	/* замена команд, типы операндов которых известны, командами для чисел и многочленов :
+	*      +, -, *, /, %           ->    int_arith, poly_arith          (оба операнда --- числа или оба --- многочлены)
+	*      =, !=, <, <=, >, >=     ->    int_compare                    (оба операнда --- числа)
+	*      суперкоманды            ->    int_arith_var_var ... int_ji_cmp_const  (все операнды --- числа)
+	*  остальные команды не меняются ; их быстрый путь для чисел проверяет типы во время выполнения */
+	static void specialize(Bytecode& bytecode) {
+		std::vector<Instruction> instructions = decode(bytecode);
+		std::vector<TypeState> states = infer_types(instructions, bytecode);
+
+		for (int index = 0; index < instructions.size(); index++) {
+			const TypeState& state = states[index];
+			if (!state.reached) continue;
+
+			Instruction& instruction = instructions[index];
+			auto variable_is_int = [&](int operand) { return state.variables[instruction.operands[operand]] == StaticType::Integer; };
+			auto constant_is_int = [&](int operand) { return bytecode.constants[instruction.operands[operand]].get_type() == ValueType::Integer; };
+			bool top_ints = state.top(0) == StaticType::Integer && state.top(1) == StaticType::Integer;
+
+			switch (instruction.op) {
+			case OpAdd: case OpSub: case OpMul: case OpDiv: case OpMod:
+				if (top_ints || (state.top(0) == StaticType::Polynomial && state.top(1) == StaticType::Polynomial)) {
+					instruction.operands[0] = instruction.op;
+					instruction.op = top_ints ? OpIntArith : OpPolyArith;
+				}
+				break;
+			case OpEqual: case OpNotEqual: case OpLess: case OpLessOrEqual: case OpBigger: case OpBiggerOrEqual:
+				if (top_ints) {
+					instruction.operands[0] = instruction.op;
+					instruction.op = OpIntCompare;
+				}
+				break;
+
+			case OpArithVarVar:    if (variable_is_int(0) && variable_is_int(1)) instruction.op = OpIntArithVarVar;    break;
+			case OpArithVarConst:  if (variable_is_int(0) && constant_is_int(1)) instruction.op = OpIntArithVarConst;  break;
+			case OpUpdateVarConst: if (variable_is_int(0) && constant_is_int(1)) instruction.op = OpIntUpdateVarConst; break;
+			case OpJiCmpVarVar:    if (variable_is_int(0) && variable_is_int(1)) instruction.op = OpIntJiCmpVarVar;    break;
+			case OpJiCmpVarConst:  if (variable_is_int(0) && constant_is_int(1)) instruction.op = OpIntJiCmpVarConst;  break;
+			case OpJiCmpConst:     if (state.top(0) == StaticType::Integer && constant_is_int(0)) instruction.op = OpIntJiCmpConst; break;
+
+			default: break;
+			}
+		}
+
+		encode(instructions, bytecode);
+	}
+public:
+	static Bytecode compile(const ParsedProgram& program, bool fuse_sequences = true, bool optimize_code = true, bool specialize_types = true) {
+		const std::vector<Token>& tokens = program.tokens;
+
+		Bytecode bytecode;
+
+		// смещение первой команды, порождённой лексемой с данным индексом или следующими за ней
+		std::vector<int> token_offset(tokens.size() + 1);
+		// (смещение операнда перехода, индекс лексемы перехода) : операнд заполняется после генерации кода
+		std::vector<std::pair<int, int>> jumps;
+		// номер ячейки переменной по её индексу в таблице имён
+		std::map<int, int> slots;
+		auto slot = [&](int name_table_index) {
+			auto found = slots.find(name_table_index);
+			if (found != slots.end()) return found->second;
+
+			int new_slot = bytecode.slot_names.size();
+			slots[name_table_index] = new_slot;
+			bytecode.slot_names.push_back(*(std::string*)program.name_table[name_table_index].name_pointer);
+			return new_slot;
+		};
+		// номер константы в пуле по её индексу в таблице имён
+		std::map<int, int> pool_indices;
+		auto constant = [&](int name_table_index) {
+			auto found = pool_indices.find(name_table_index);
+			if (found != pool_indices.end()) return found->second;
+
+			const ObjectName& name = program.name_table[name_table_index];
+			int new_index = bytecode.constants.size();
+			pool_indices[name_table_index] = new_index;
+			switch (name.type) {
+			case ObjectType::IntConstant: bytecode.constants.push_back(Object(*(int*)name.name_pointer));        break;
+			case ObjectType::PolConstant: bytecode.constants.push_back(Object(*(Polynomial*)name.name_pointer)); break;
+			case ObjectType::Variable:    break;
+			}
+			return new_index;
+		};
+
+		for (int token_index = 0; token_index < tokens.size(); token_index++) {
+			const Token& token = tokens[token_index];
+			token_offset[token_index] = bytecode.code.size();
+
+			switch (token.token_class) {
+			case Push:
+				if (program.name_table[token.value].type == ObjectType::Variable) bytecode.emit(OpPushVar, slot(token.value), token.line);
+				else                                                              bytecode.emit(OpPush,    constant(token.value), token.line);
+				break;
+			case Pop:   bytecode.emit(OpPop,  slot(token.value), token.line); break;
+			case Jmp:
+			case Ji:
+				bytecode.emit(token.token_class == Jmp ? OpJmp : OpJi, 0, token.line);
+				jumps.push_back({ (int)bytecode.code.size() - 1, token_index });
+				break;
+			case Read:  bytecode.emit(OpRead,  token.line); break;
+			case Write: bytecode.emit(OpWrite, token.line); break;
+			case End:   bytecode.emit(OpEnd,   token.line); break;
+
+			case ArithmeticOp:
+				switch (token.value) {
+				case '+': bytecode.emit(OpAdd, token.line); break;
+				case '-': bytecode.emit(OpSub, token.line); break;
+				case '*': bytecode.emit(OpMul, token.line); break;
+				case '/': bytecode.emit(OpDiv, token.line); break;
+				case '%': bytecode.emit(OpMod, token.line); break;
+				}
+				break;
+			case CmpOp:
+				switch (token.value) {
+				case Equal:         bytecode.emit(OpEqual,         token.line); break;
+				case NotEqual:      bytecode.emit(OpNotEqual,      token.line); break;
+				case Less:          bytecode.emit(OpLess,          token.line); break;
+				case LessOrEqual:   bytecode.emit(OpLessOrEqual,   token.line); break;
+				case Bigger:        bytecode.emit(OpBigger,        token.line); break;
+				case BiggerOrEqual: bytecode.emit(OpBiggerOrEqual, token.line); break;
+				}
+				break;
+
+			case Atpow:      bytecode.emit(OpAtpow,      token.line); break;
+			case Deg:        bytecode.emit(OpDeg,        token.line); break;
+			case Derivative: bytecode.emit(OpDerivative, token.line); break;
+			case Value:      bytecode.emit(OpValue,      token.line); break;
+			case MVar:       bytecode.emit(OpMVar,       token.line); break;
+			case Roots:      bytecode.emit(OpRoots,      token.line); break;
+			case DerivN:     bytecode.emit(OpDerivN,     token.line); break;
+			case Shift:      bytecode.emit(OpShift,      token.line); break;
+
+			case EndOfFile:  bytecode.emit(OpEnd,        token.line); break;
+
+			case Comment:
+			case Error:      break;
+			}
+		}
+		token_offset[tokens.size()] = bytecode.code.size();
+
+		// общая команда для переходов, которые не удалось разрешить
+		int fail_offset = bytecode.code.size();
+		bytecode.emit(OpFail, tokens.empty() ? 0 : tokens.back().line);
+
+		bytecode.halt_offset = bytecode.code.size();
+		bytecode.emit(OpHalt, tokens.empty() ? 0 : tokens.back().line);
+
+		// первая лексема каждой строки
+		int last_line = tokens.empty() ? 0 : tokens.back().line;
+		std::vector<int> first_token_of_line(last_line + 1, -1);
+		for (int token_index = tokens.size() - 1; token_index >= 0; token_index--) {
+			if (tokens[token_index].line >= 0) first_token_of_line[tokens[token_index].line] = token_index;
+		}
+
+		for (auto& jump : jumps) {
+			const ObjectName& target = program.name_table[tokens[jump.second].value];
+			int line_to_jump = *(int*)target.name_pointer;
+
+			int target_offset = fail_offset;
+			if (line_to_jump > 0 && line_to_jump <= last_line && first_token_of_line[line_to_jump] >= 0) {
+				target_offset = token_offset[first_token_of_line[line_to_jump]];
+			}
+
+			bytecode.code[jump.first] = target_offset;
+		}
+
+		if (optimize_code)    optimize(bytecode);
+		if (fuse_sequences)   fuse(bytecode);
+		if (specialize_types) specialize(bytecode);
+
+		return bytecode;
+	}
+};
@@ -0,0 +1,75 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "thread_pool.hpp"
+#include "snapshot.cpp"
+
+/* класс "параллельный исполнитель" : одна скомпилированная программа исполняется на многих записях ввода
+*  (как Interpreter::run_record) в пуле потоков
+*
+*  записи делятся на части из подряд идущих записей ; каждая часть исполняется в своём интерпретаторе,
+*  а программа у всех интерпретаторов общая и только читается, поэтому блокировок при исполнении нет ;
+*  результат записи i кладётся на место i, так что результаты идут в порядке записей */
+class ParallelExecutor {
+private:
+	std::shared_ptr<const CompiledProgram> program;
+	ThreadPool                             pool;
+	DispatchMode                           dispatch_mode;
+	bool                                   stack_checks;
+public:
+	// частей на поток : у потока, который закончил раньше, будет что перехватить
+	static const int PARTS_PER_THREAD = 4;
+
+	// count_threads = 0 --- по количеству ядер
+	ParallelExecutor(std::shared_ptr<const CompiledProgram> _program, int count_threads = 0)
+		: program(std::move(_program)),
+		  pool(count_threads > 0 ? count_threads : std::max(1, (int)std::thread::hardware_concurrency())),
+		  dispatch_mode(INTERPRETER_COMPUTED_GOTO ? DispatchMode::Threaded : DispatchMode::Switch),
+		  stack_checks(false) {}
+
+	// режимы исполнения для всех интерпретаторов (см. Interpreter)
+	void set_dispatch_mode(DispatchMode mode) {
+		dispatch_mode = mode;
+	}
+	void set_stack_checks(bool _stack_checks) {
+		stack_checks = _stack_checks;
+	}
+
+	int count_threads() const {
+		return pool.size();
+	}
+
+	/* результаты всех записей в порядке записей ; start --- снимок, с которого начинается каждая запись
+	*  (у каждой части своя копия снимка, записи части запускаются из неё без копирования многочленов) */
+	std::vector<std::string> run_records(const std::vector<std::string>& records, char separator,
+										 const InterpreterSnapshot* start = nullptr) {
+		std::vector<std::string> results(records.size());
+		if (records.empty()) return results;
+
+		int count_parts = (int)std::min<std::size_t>(records.size(), (std::size_t)pool.size() * PARTS_PER_THREAD);
+
+		TaskGroup group(pool);
+		for (int part = 0; part < count_parts; part++) {
+			std::size_t first = records.size() * part / count_parts;
+			std::size_t last  = records.size() * (part + 1) / count_parts;
+
+			group.run([this, &records, &results, separator, start, first, last]() {
+				Interpreter interpreter(program);
+				interpreter.set_dispatch_mode(dispatch_mode);
+				interpreter.set_stack_checks(stack_checks);
+
+				InterpreterSnapshot snapshot;
+				if (start) snapshot = start->clone();
+
+				for (std::size_t i = first; i < last; i++) {
+					results[i] = interpreter.run_record(records[i], separator, start ? &snapshot : nullptr);
+				}
+			});
+		}
+		group.wait();
+
+		return results;
+	}
+};
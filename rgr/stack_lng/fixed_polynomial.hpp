@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <iostream>
+#include "polynomial.hpp"
+
+/* класс "многочлен фиксированной ёмкости" : многочлен степени не выше N - 1,
+*  коэффициенты которого хранятся в std::array (coeffs[i] --- коэффициент при x^i)
+*
+*  память не выделяется, все операции constexpr : циклы имеют постоянное число шагов N,
+*  поэтому для малых N компилятор полностью их разворачивает, а константные многочлены
+*  можно вычислять на этапе компиляции:
+*
+*      constexpr FixedPolynomial<3> p({ 1, 0, 2 });          // 1 + 2x^2
+*      constexpr float p_at_2 = p(2);                        // 9
+*      constexpr FixedPolynomial<5> q = p * p;               // ёмкость 3 + 3 - 1
+*/
+template <int N>
+class FixedPolynomial {
+	static_assert(N > 0, "FixedPolynomial: ёмкость должна быть положительной");
+private:
+	std::array<float, N> coeffs;
+
+	template <int M> friend class FixedPolynomial;
+
+	static constexpr int max(int a, int b) { return a > b ? a : b; }
+public:
+	constexpr FixedPolynomial() : coeffs{} {}
+	constexpr FixedPolynomial(float coeff) : coeffs{} {
+		coeffs[0] = coeff;
+	}
+	constexpr FixedPolynomial(int power, float coeff) : coeffs{} {
+		coeffs[power] = coeff;
+	}
+	constexpr explicit FixedPolynomial(const std::array<float, N>& _coeffs) : coeffs(_coeffs) {}
+
+	/* преобразование из обычного многочлена ;
+	*  выбрасывает исключение 1, если степень многочлена не меньше N */
+	explicit FixedPolynomial(const Polynomial& polynomial) : coeffs{} {
+		if (polynomial.deg() >= N) throw 1;
+
+		for (int pow = 0; pow < N; pow++) {
+			coeffs[pow] = polynomial[pow];
+		}
+	}
+
+	// преобразование в обычный многочлен (нулевые коэффициенты не сохраняются)
+	operator Polynomial() const {
+		int   powers[N];
+		float nonzero[N];
+		int   count_terms = 0;
+
+		for (int pow = 0; pow < N; pow++) {
+			if (coeffs[pow] == 0) continue;
+
+			powers[count_terms]  = pow;
+			nonzero[count_terms] = coeffs[pow];
+			count_terms++;
+		}
+
+		return Polynomial(powers, nonzero, count_terms);
+	}
+
+	// ёмкость : наибольшее количество коэффициентов
+	static constexpr int capacity() { return N; }
+
+	// нахождение значения многочлена при заданном x (схема Горнера)
+	constexpr float operator ()(float x) const {
+		float eval = 0;
+		for (int pow = N - 1; pow >= 0; pow--) {
+			eval = eval * x + coeffs[pow];
+		}
+		return eval;
+	}
+
+	// возвращает коэффициент при заданной степени
+	constexpr float operator [](int power) const {
+		if (power < 0 || power >= N) return 0;
+		return coeffs[power];
+	}
+
+	// изменение коэффициента при заданной степени (power < N)
+	constexpr void set(int power, float coeff) {
+		coeffs[power] = coeff;
+	}
+
+	template <int M>
+	constexpr FixedPolynomial<max(N, M)> operator +(const FixedPolynomial<M>& added) const {
+		FixedPolynomial<max(N, M)> sum;
+		for (int pow = 0; pow < max(N, M); pow++) {
+			sum.coeffs[pow] = (*this)[pow] + added[pow];
+		}
+		return sum;
+	}
+
+	constexpr FixedPolynomial operator -() const {
+		FixedPolynomial negative;
+		for (int pow = 0; pow < N; pow++) {
+			negative.coeffs[pow] = -coeffs[pow];
+		}
+		return negative;
+	}
+
+	template <int M>
+	constexpr FixedPolynomial<max(N, M)> operator -(const FixedPolynomial<M>& subbed) const {
+		FixedPolynomial<max(N, M)> dif;
+		for (int pow = 0; pow < max(N, M); pow++) {
+			dif.coeffs[pow] = (*this)[pow] - subbed[pow];
+		}
+		return dif;
+	}
+
+	template <int M>
+	constexpr FixedPolynomial<N + M - 1> operator *(const FixedPolynomial<M>& multed) const {
+		FixedPolynomial<N + M - 1> prod;
+		for (int pow1 = 0; pow1 < N; pow1++) {
+			for (int pow2 = 0; pow2 < M; pow2++) {
+				prod.coeffs[pow1 + pow2] += coeffs[pow1] * multed.coeffs[pow2];
+			}
+		}
+		return prod;
+	}
+
+	constexpr FixedPolynomial operator *(float scalar) const {
+		FixedPolynomial prod;
+		for (int pow = 0; pow < N; pow++) {
+			prod.coeffs[pow] = coeffs[pow] * scalar;
+		}
+		return prod;
+	}
+
+	template <int M>
+	constexpr bool operator ==(const FixedPolynomial<M>& polynomial) const {
+		for (int pow = 0; pow < max(N, M); pow++) {
+			if ((*this)[pow] != polynomial[pow]) return false;
+		}
+		return true;
+	}
+	template <int M>
+	constexpr bool operator !=(const FixedPolynomial<M>& polynomial) const {
+		return !(*this == polynomial);
+	}
+
+	// степень многочлена (у нулевого многочлена --- ноль)
+	constexpr int deg() const {
+		int max_power = 0;
+		for (int pow = 0; pow < N; pow++) {
+			if (coeffs[pow] != 0) max_power = pow;
+		}
+		return max_power;
+	}
+
+	// производная
+	constexpr FixedPolynomial<(N > 1 ? N - 1 : 1)> derivative() const {
+		FixedPolynomial<(N > 1 ? N - 1 : 1)> derived;
+		for (int pow = 1; pow < N; pow++) {
+			derived.coeffs[pow - 1] = coeffs[pow] * pow;
+		}
+		return derived;
+	}
+
+	// вывод в формате Polynomial
+	friend std::ostream& operator <<(std::ostream& stream, const FixedPolynomial& polynomial) {
+		return stream << Polynomial(polynomial);
+	}
+};
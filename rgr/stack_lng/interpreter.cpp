@@ -1,481 +1,888 @@
 #include <iostream>
-#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
 #include "polynomial.hpp"
-#include "parser.cpp"
-
-/* перечисление типов значений объектов в стековом языке : натуральное число и многочлен с вещественными коэффициентами */
-enum class ValueType { Integer, Polynomial };
-
-/* класс "объект"; состоит из указателя на реальное значени и значение типа */
-class Object {
-private:
-	void* value_pointer;
-	ValueType type;
-public:
-	/* конструкторы и декструкоры ; операторы присваивания */
-	Object(void* ptr = nullptr, ValueType t = ValueType::Integer) {
-		value_pointer = ptr;
-		type = t;
-	}
-	void clear() {
-		if (value_pointer) {
-			switch (type) {
-			case ValueType::Integer:    delete (int*)value_pointer; 	   break;
-			case ValueType::Polynomial: delete (Polynomial*)value_pointer; break; 
-			}
-		}
-		value_pointer = nullptr;
-		type = ValueType::Integer;
-	}
-	~Object() {
-		clear();
-	}
-	Object(const Object& other) {
-		type = other.type;
-		switch (type) {
-		case ValueType::Integer:    value_pointer = new int(*(int*)other.value_pointer); 			   break;
-		case ValueType::Polynomial: value_pointer = new Polynomial(*(Polynomial*)other.value_pointer); break;
-		}
-	}
-	Object(Object&& other) {
-		type = other.type;
-		other.type = ValueType::Integer;
-
-		value_pointer = other.value_pointer;
-		other.value_pointer = nullptr;
+#include "multivariate.hpp"
+#include "polynomial_roots.hpp"
+#include "buffered_io.hpp"
+#include "polynomial_alloc.hpp"
+#include "tracer.cpp"
+
+/* шитый код (переходы по адресам меток) есть только в GCC и Clang ;
+*  его можно отключить, определив INTERPRETER_COMPUTED_GOTO 0 при компиляции */
+#ifndef INTERPRETER_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define INTERPRETER_COMPUTED_GOTO 1
+#else
+#define INTERPRETER_COMPUTED_GOTO 0
+#endif
+#endif
+
+/* частоты последовательностей команд : строка вида "push var / push const / + / pop" -> сколько раз исполнена */
+using SequenceCounts = std::map<std::string, long long>;
+
+/* вывод самых выгодных для слияния в суперкоманду последовательностей :
+*  выгода --- количество сэкономленных выборов команд, (длина - 1) * частота */
+void print_sequence_counts(const SequenceCounts& counts, std::ostream& stream, int count_top = 20) {
+	std::vector<std::pair<long long, std::string>> ranked;
+	for (auto& sequence : counts) {
+		int length = 1;
+		for (char c : sequence.first) if (c == '/') length++;
+
+		ranked.push_back({ (length - 1) * sequence.second, sequence.first });
+	}
+	std::sort(ranked.begin(), ranked.end(), [](const std::pair<long long, std::string>& a, const std::pair<long long, std::string>& b) { return a.first > b.first; });
+
+	stream << "сэкономлено выборов команд    последовательность\n";
+	for (int i = 0; i < ranked.size() && i < count_top; i++) {
+		stream.width(26); stream << ranked[i].first << "    " << ranked[i].second << '\n';
+	}
+}
+
+/* способ выбора очередной команды : оператор switch или шитый код
+*  (если компилятор не поддерживает шитый код, всегда используется switch) */
+enum class DispatchMode { Switch, Threaded };
+
+/* снимок состояния интерпретатора : стек, значения переменных и смещение следующей команды
+*
+*  объекты в снимке делят блоки многочленов с объектами интерпретатора (значения не изменяются),
+*  поэтому снимок и запуск из снимка стоят столько же, сколько копирование векторов объектов ;
+*  счётчики ссылок не атомарные : интерпретатору в другом потоке передаётся копия clone */
+struct InterpreterSnapshot {
+	std::vector<Object> stack;
+	std::vector<Object> variables;
+	int                 pc = 0;
+
+	// копия в собственных блоках ; многочлены, общие для нескольких объектов снимка, общие и в копии
+	InterpreterSnapshot clone() const {
+		std::unordered_map<const void*, Object> copies;
+		auto copy = [&copies](const Object& obj) {
+			if (!obj.block()) return obj.clone();
+
+			auto found = copies.find(obj.block());
+			if (found == copies.end()) found = copies.emplace(obj.block(), obj.clone()).first;
+			return found->second;
+		};
+
+		InterpreterSnapshot result;
+		result.pc = pc;
+		for (const Object& obj : stack)     result.stack.push_back(copy(obj));
+		for (const Object& obj : variables) result.variables.push_back(copy(obj));
+		return result;
 	}
-	Object& operator=(const Object& other) {
-		if (this == &other) return *this;
-
-		clear();
+};
 
-		type = other.type;
-		switch (type) {
-		case ValueType::Integer:    value_pointer = new int(*(int*)other.value_pointer); 			   break;
-		case ValueType::Polynomial: value_pointer = new Polynomial(*(Polynomial*)other.value_pointer); break;
-		}
+/* скомпилированная программа : байт-код и результат проверки стека ; после создания не изменяется,
+*  поэтому одну программу могут одновременно исполнять несколько интерпретаторов в разных потоках */
+struct CompiledProgram {
+	Bytecode   bytecode;
+	StackCheck stack_check;
 
-		return *this;
-	}
-	Object& operator=(Object&& other) {
-		if (this == &other) return *this;
-
-		clear();
-
-		type = other.type;
-		other.type = ValueType::Integer;
-
-		value_pointer = other.value_pointer;
-		other.value_pointer = nullptr;
-
-		return *this;
-	}
-
-	/* доступ к полям */
-	ValueType get_type() {
-		return type;
-	}
-	void* get_ptr() {
-		return value_pointer;
-	}
-	void set(void* ptr, ValueType _type) {
-		clear();
-
-		value_pointer = ptr;
-		type = _type;
-	}
-
-/* макрос с параметорм : значок операции +, -, *, /, %
-*  применяет операцию к двум объектам ; используется только в соостветсвующих операторах
-*  т. к. использует имена формальных параметров */
-#define CALCULATE(infix_operator) \
-		int* int_ptr1 = nullptr; Polynomial* pol_ptr1 = nullptr;\
-		switch (type) {\
-		case ValueType::Integer:    int_ptr1 = (int*)        value_pointer; break;\
-		case ValueType::Polynomial: pol_ptr1 = (Polynomial*) value_pointer; break;\
-		}\
-		int* int_ptr2 = nullptr; Polynomial* pol_ptr2 = nullptr;\
-		switch (other.type) {\
-		case ValueType::Integer:    int_ptr2 = (int*)        other.value_pointer; break;\
-		case ValueType::Polynomial: pol_ptr2 = (Polynomial*) other.value_pointer; break;\
-		}\
-\
-		Object new_obj;\
-		if (int_ptr1 && int_ptr2) {\
-			new_obj.set(new int(*int_ptr1 infix_operator *int_ptr2), ValueType::Integer);\
-		}\
-		if (pol_ptr1 && int_ptr2) {\
-			new_obj.set(new Polynomial(*pol_ptr1 infix_operator Polynomial(*int_ptr2)), ValueType::Polynomial);\
-		}\
-		if (int_ptr1 && pol_ptr2) {\
-			new_obj.set(new Polynomial(Polynomial(*int_ptr1) infix_operator *pol_ptr2), ValueType::Polynomial);\
-		}\
-		if (pol_ptr1 && pol_ptr2) {\
-			new_obj.set(new Polynomial(*pol_ptr1 infix_operator *pol_ptr2), ValueType::Polynomial);\
-		}\
-		return new_obj;
-// end define
-
-	/* операторы арифметических дейсвий с объектами */
-	Object operator +(const Object& other) const {
-		CALCULATE(+)
-	}
-	Object operator -(const Object& other) const {
-		CALCULATE(-)
-	}
-	Object operator *(const Object& other) const {
-		CALCULATE(*)
-	}
-	Object operator /(const Object& other) const {
-		CALCULATE(/)
-	}
-	Object operator %(const Object& other) const {
-		CALCULATE(%)
-	}
-
-/* аналогичный макрос для сравнений ==, != */
-#define COMPARE_1(infix_operator) \
-		int* int_ptr1 = nullptr; Polynomial* pol_ptr1 = nullptr;\
-		switch (type) {\
-		case ValueType::Integer:    int_ptr1 = (int*)        value_pointer; break;\
-		case ValueType::Polynomial: pol_ptr1 = (Polynomial*) value_pointer; break;\
-		}\
-		int* int_ptr2 = nullptr; Polynomial* pol_ptr2 = nullptr;\
-		switch (other.type) {\
-		case ValueType::Integer:    int_ptr2 = (int*)        other.value_pointer; break;\
-		case ValueType::Polynomial: pol_ptr2 = (Polynomial*) other.value_pointer; break;\
-		}\
-\
-		if (int_ptr1 && int_ptr2) {\
-			return *int_ptr1 infix_operator *int_ptr2;\
-		}\
-		if (pol_ptr1 && int_ptr2) {\
-			return *pol_ptr1 infix_operator Polynomial(*int_ptr2);\
-		}\
-		if (int_ptr1 && pol_ptr2) {\
-			return Polynomial(*int_ptr1) infix_operator *pol_ptr2;\
-		}\
-		if (pol_ptr1 && pol_ptr2) {\
-			return *pol_ptr1 infix_operator *pol_ptr2;\
-		}
-// end define
-
-	/* операторы сравнений */
-	bool operator ==(const Object& other) const {
-		COMPARE_1(==)
-		throw 1;
-	}
-	bool operator !=(const Object& other) const {
-		COMPARE_1(!=)
-		throw 1;
-	}
-
-/* аналогичный макрос для операций <, <=, >, >= */
-#define COMPARE_2(infix_operator) \
-		int* int_ptr1 = nullptr; Polynomial* pol_ptr1 = nullptr;\
-		switch (type) {\
-		case ValueType::Integer:    int_ptr1 = (int*)        value_pointer; break;\
-		case ValueType::Polynomial: pol_ptr1 = (Polynomial*) value_pointer; break;\
-		}\
-		int* int_ptr2 = nullptr; Polynomial* pol_ptr2 = nullptr;\
-		switch (other.type) {\
-		case ValueType::Integer:    int_ptr2 = (int*)        other.value_pointer; break;\
-		case ValueType::Polynomial: pol_ptr2 = (Polynomial*) other.value_pointer; break;\
-		}\
-\
-		if (int_ptr1 && int_ptr2) {\
-			return *int_ptr1 infix_operator *int_ptr2;\
-		}
-// end define
-
-	/* операторы сравнений <, <=, >, >= 
-	* выбрасывют исключение 1, если не удалось сравнить объекты,
-	* например, если один операнд - число, а другой - многчлен */
-	bool operator <(const Object& other) const {
-		COMPARE_2(<)
-		throw 1;
-	}
-	bool operator <=(const Object& other) const {
-		COMPARE_2(<=)
-		throw 1;
-	}
-	bool operator >(const Object& other) const {
-		COMPARE_2(>)
-		throw 1;
-	}
-	bool operator >=(const Object& other) const {
-		COMPARE_2(>=)
-		throw 1;
-	}
+	CompiledProgram(Bytecode&& _bytecode) : bytecode(std::move(_bytecode)), stack_check(StackVerifier::verify(bytecode)) {}
 };
 
+/* класс "интерпретатор" : контекст исполнения одной скомпилированной программы
+*  (стек, переменные, смещение команды, ввод и вывод, режимы исполнения)
+*
+*  программа общая и только читается ; константы копируются в контекст, т. к. счётчики ссылок
+*  у многочленов не атомарные : значения, которые попадают в стек, не делят блоки с другими контекстами */
 class Interpreter {
 private:
 	std::vector<Object> 			Stack;		// стек
-	std::map<std::string, Object> 	Variables;	// отображение (строка (имя переменной) - объект)
+	std::vector<Object> 			Variables;	// значения переменных по номерам ячеек
 
-	ParsedProgram program;						// интерпретируемая программа
+	std::shared_ptr<const CompiledProgram> program;	// интерпретируемая программа
+	const Bytecode&                        bytecode;	// её байт-код
+	std::vector<Object>                    constants;	// копия пула констант программы
 
-	int executable_token_index;					// номер (индекс) исполняемой лексемы
+	int pc;										// смещение следующей исполняемой команды
 
 	bool interpreting;							// флаг интерпретации
+
+	DispatchMode              dispatch_mode;	// способ выбора команд
+	bool                      counting;			// режим подсчёта исполнений команд
+	std::vector<long long>    executed;			// сколько раз исполнена команда с данным смещением
+	bool                      profiling;		// режим профилирования
+	ExecutionProfile          profile;			// исполнения и время команд (накапливаются между запусками)
+	std::vector<const void*>  threaded_code;	// адреса обработчиков для каждого слова кода (шитый код)
+	const void* const*        threaded_labels;	// таблица обработчиков, по которой построен threaded_code
+	InputBuffer               input;			// ввод и вывод программы (read, write, сообщения об ошибках)
+	OutputBuffer              output;
+	bool                      stack_checks;		// проверять размер стека во время выполнения
+	bool                      tracing;			// запись команд в трассу (при сборке с INTERPRETER_TRACE 1)
+	TraceBuffer               trace;			// последние исполненные команды
+	std::string               trace_file;		// файл для трассы
+	int                       trace_flags;		// параметры компиляции программы (CompileFlags)
+	bool                      trace_dumped;		// трасса уже записана при ошибке
+	PolynomialArena           record_arena;		// память многочленов одной записи пакетного режима (см. run_record)
 	
-/* макрос для проверки стека, перед извлечением оттуда объектоы */
-#define CHECK_STACK_SIZE(_size) if (Stack.size() < (_size)) { error(); return; }
+/* макрос для проверки стека, перед извлечением оттуда объектоы ;
+*  процедуры с проверкой --- шаблоны : при checked = false (программа прошла StackVerifier) проверки нет */
+#define CHECK_STACK_SIZE(_size) if (checked && Stack.size() < (_size)) { error(); return; }
+
+/* запись команды с данным смещением в трассу ; без INTERPRETER_TRACE в циклах исполнения ничего не добавляется */
+#if INTERPRETER_TRACE
+#define TRACE_INSTRUCTION(_offset) if (tracing) trace_instruction(_offset);
+#else
+#define TRACE_INSTRUCTION(_offset)
+#endif
 
 	// ---------------------------------------
 	// процедуры интерпретатора
 	// ---------------------------------------
-	void push(int name_table_index) {
-		ObjectName& obj_name = program.name_table[name_table_index];
-
-		Object new_obj;
-		switch (obj_name.type) {
-		case ObjectType::Variable:    if (Variables.count(*(std::string*)obj_name.name_pointer) == 0) { error(); return; }
-								      new_obj = Variables[*(std::string*)obj_name.name_pointer];
-								      break;								
-		case ObjectType::IntConstant: new_obj.set(new int(*(int*)obj_name.name_pointer), ValueType::Integer); 				   break;
-		case ObjectType::PolConstant: new_obj.set(new Polynomial(*(Polynomial*)obj_name.name_pointer), ValueType::Polynomial); break;
-		}
+	void push(int constant) {
+		Stack.push_back(constants[constant]);
+	}
+	void push_variable(int slot) {
+		if (Variables[slot].get_type() == ValueType::Uninitialized) { error(); return; }
 
-		Stack.push_back(std::move(new_obj));
-		executable_token_index++;
+		Stack.push_back(Variables[slot]);
 	}
-	void pop(int name_table_index) {
+	template <bool checked>
+	void pop(int slot) {
 		CHECK_STACK_SIZE(1)
 
-		ObjectName& obj_name = program.name_table[name_table_index];
-
-		Object obj = std::move(Stack.back());
+		Variables[slot] = std::move(Stack.back());
 		Stack.pop_back();
-
-		Variables[*(std::string*)obj_name.name_pointer] = obj;
-
-		executable_token_index++;
 	}
-	void jmp(int name_table_index) {
-		ObjectName& obj_name = program.name_table[name_table_index];
-		int line_to_jump = *(int*)obj_name.name_pointer;
-
-		if (line_to_jump == 0) { error(); return; }
-
-		for (int token_index = line_to_jump - 1; token_index < program.tokens.size(); ++token_index) {
-			if (program.tokens[token_index].line == line_to_jump) {
-				executable_token_index = token_index;
-				return;
-			}
-		}
-
-		error();
+	void jmp(int target) {
+		pc = target;
 	}
-	void ji(int name_table_index) {
+	template <bool checked>
+	void ji(int target) {
 		CHECK_STACK_SIZE(1)
 
-		Object obj = std::move(Stack.back());
+		bool jump = Stack.back().truth();
 		Stack.pop_back();
 
-		bool jump;
-		switch (obj.get_type()) {
-		case ValueType::Integer:   	jump = *(int*)       obj.get_ptr(); break;
-		case ValueType::Polynomial:	jump = *(Polynomial*)obj.get_ptr(); break;
-		}
-
-		if (jump) jmp(name_table_index);
-		else      executable_token_index++;
+		if (jump) jmp(target);
 	}
 	void read() {
-		while (std::cin.peek() == ' ' || std::cin.peek() == '\n' || std::cin.peek() == '\t') std::cin.ignore();
+		input.skip_spaces();
 
-		Object new_obj;
-		if (isdigit(std::cin.peek())) {
-			int* n = new int; std::cin >> *n;
-			new_obj.set(n, ValueType::Integer);
+		if (isdigit(input.peek())) {
+			int n; input.read_int(n);
+			Stack.push_back(Object(n));
 		}
-		else if (std::cin.peek() == '[') {
-			Polynomial* p = new Polynomial; std::cin >> *p;
-			new_obj.set(p, ValueType::Polynomial);
+		else if (input.peek() == '[') {
+			Polynomial p;
+			if (!input.read_polynomial(p)) { error(); return; }
+			Stack.push_back(Object(std::move(p)));
 		}
 		else { error(); return; }
-
-		Stack.push_back(std::move(new_obj));
-		executable_token_index++;
 	}
+	template <bool checked>
 	void write() {
 		CHECK_STACK_SIZE(1)
 
-		Object obj = std::move(Stack.back());
+		write_object(Stack.back());
+		output.write('\n');
 		Stack.pop_back();
-
+	}
+	// вывод значения (многочлен от нескольких переменных печатается через поток)
+	void write_object(const Object& obj) {
 		switch (obj.get_type()) {
-		case ValueType::Integer:    std::cout << *(int*)       obj.get_ptr(); break;
-		case ValueType::Polynomial: std::cout << *(Polynomial*)obj.get_ptr(); break;
+		case ValueType::Integer:    output.write(obj.get_int());        break;
+		case ValueType::Polynomial: output.write(obj.get_polynomial()); break;
+		default: {
+			std::ostringstream stream;
+			stream << obj;
+			output.write(stream.str());
+			break;
+		}
 		}
-		std::cout << std::endl;
-		executable_token_index++;
 	}
 	void end() {
+		pc = bytecode.halt_offset;
 		interpreting = false;
 	}
 
-	void calculate(char operation) {
+	template <bool checked>
+	void calculate(OpCode operation) {
 		CHECK_STACK_SIZE(2)
 
-		Object obj2 = std::move(Stack.back());
-		Stack.pop_back();
-		Object obj1 = std::move(Stack.back());
-		Stack.pop_back();
+		// результат записывается на место первого операнда
+		Object& obj1 = Stack[Stack.size() - 2];
+		Object& obj2 = Stack.back();
 
-		switch (operation) {
-		case '+': Stack.push_back(obj1 + obj2); break;
-		case '-': Stack.push_back(obj1 - obj2); break;
-		case '*': Stack.push_back(obj1 * obj2); break;
-		case '/': Stack.push_back(obj1 / obj2); break;
-		case '%': Stack.push_back(obj1 % obj2); break;
+		try {
+			obj1 = apply_arithmetic(operation, obj1, obj2);
+			Stack.pop_back();
 		}
-		executable_token_index++;
+		catch (...) { error(); }
 	}
-	void compare(CmpValue operation) {
+	template <bool checked>
+	void compare(OpCode operation) {
 		CHECK_STACK_SIZE(2)
 
-		Object obj2 = std::move(Stack.back());
-		Stack.pop_back();
-		Object obj1 = std::move(Stack.back());
-		Stack.pop_back();
+		Object& obj1 = Stack[Stack.size() - 2];
+		Object& obj2 = Stack.back();
 
 		try {
-			bool cmp_result;
-
-			switch (operation) {
-			case Equal:			cmp_result = (obj1 == obj2); break;
-			case NotEqual:		cmp_result = (obj1 != obj2); break;
-			case Less:			cmp_result = (obj1 <  obj2); break;
-			case LessOrEqual:	cmp_result = (obj1 <= obj2); break;
-			case Bigger:		cmp_result = (obj1 >  obj2); break;
-			case BiggerOrEqual:	cmp_result = (obj1 >= obj2); break;
-			}
+			obj1 = Object(apply_comparison(operation, obj1, obj2));
+			Stack.pop_back();
+		}
+		catch (...) { error(); }
+	}
 
-			Stack.push_back(Object(new int(cmp_result), ValueType::Integer));
-			executable_token_index++;
+	// функция с одним операндом (OpDeg, OpDerivative, OpMVar) : результат заменяет вершину стека
+	template <bool checked>
+	void function(OpCode operation) {
+		CHECK_STACK_SIZE(1)
+
+		Object& obj = Stack.back();
+
+		try { obj = apply_function(operation, obj); }
+		catch (...) { error(); }
+	}
+	// функция с двумя операндами (OpAtpow, OpValue, OpDerivN, OpShift)
+	template <bool checked>
+	void function_2(OpCode operation) {
+		CHECK_STACK_SIZE(2)
+
+		Object& obj1 = Stack[Stack.size() - 2];
+		Object& obj2 = Stack.back();
+
+		try {
+			obj1 = apply_function(operation, obj1, obj2);
+			Stack.pop_back();
 		}
 		catch (...) { error(); }
 	}
 
-	void deg() {
+	/* roots : заменить многочлен на вершине стека его действительными корнями (многочленами нулевой степени)
+	*  и их количеством ; корни кладутся по убыванию, так что под количеством лежит наименьший корень */
+	template <bool checked>
+	void roots() {
 		CHECK_STACK_SIZE(1)
 
 		Object obj = std::move(Stack.back());
 		Stack.pop_back();
 
-		Polynomial p;
-		switch (obj.get_type()) {
-		case ValueType::Integer:    p = *(int*)       obj.get_ptr(); break;
-		case ValueType::Polynomial: p = *(Polynomial*)obj.get_ptr(); break;
+		if (obj.get_type() == ValueType::Multivariate) { error(); return; }
+
+		Polynomial buffer;
+		std::vector<float> found = PolynomialRoots::real_roots(obj.as_polynomial(buffer));
+		for (int i = found.size() - 1; i >= 0; i--) {
+			Stack.push_back(Object(found[i] == 0 ? Polynomial() : Polynomial(found[i])));
 		}
+		Stack.push_back(Object((int)found.size()));
+	}
+
+	// ---------------------------------------
+	// суперкоманды (см. OpCode) ; если оба операнда --- числа, результат вычисляется сразу,
+	// иначе --- общей операцией с проверкой типов
+	// ---------------------------------------
+	static bool both_integers(const Object& obj1, const Object& obj2) {
+		return obj1.get_type() == ValueType::Integer && obj2.get_type() == ValueType::Integer;
+	}
+
+	void push_var_var(int slot1, int slot2) {
+		if (Variables[slot1].get_type() == ValueType::Uninitialized || Variables[slot2].get_type() == ValueType::Uninitialized) { error(); return; }
+
+		Stack.push_back(Variables[slot1]);
+		Stack.push_back(Variables[slot2]);
+	}
+	void arith_var_var(int slot1, int slot2, int operation) {
+		if (both_integers(Variables[slot1], Variables[slot2])) { int_arith_var_var(slot1, slot2, operation); return; }
+		if (Variables[slot1].get_type() == ValueType::Uninitialized || Variables[slot2].get_type() == ValueType::Uninitialized) { error(); return; }
+
+		try { Stack.push_back(apply_arithmetic((OpCode)operation, Variables[slot1], Variables[slot2])); }
+		catch (...) { error(); }
+	}
+	void arith_var_const(int slot, int constant, int operation) {
+		if (both_integers(Variables[slot], constants[constant])) { int_arith_var_const(slot, constant, operation); return; }
+		if (Variables[slot].get_type() == ValueType::Uninitialized) { error(); return; }
+
+		try { Stack.push_back(apply_arithmetic((OpCode)operation, Variables[slot], constants[constant])); }
+		catch (...) { error(); }
+	}
+	void update_var_const(int slot, int constant, int operation) {
+		Object& variable = Variables[slot];
+		if (both_integers(variable, constants[constant])) { int_update_var_const(slot, constant, operation); return; }
+		if (variable.get_type() == ValueType::Uninitialized) { error(); return; }
 
-		obj.set(new int(p.deg()), ValueType::Integer);
+		try { variable = apply_arithmetic((OpCode)operation, variable, constants[constant]); }
+		catch (...) { error(); }
+	}
+	void ji_cmp_var_var(int slot1, int slot2, int operation, int target) {
+		if (both_integers(Variables[slot1], Variables[slot2])) { int_ji_cmp_var_var(slot1, slot2, operation, target); return; }
+		if (Variables[slot1].get_type() == ValueType::Uninitialized || Variables[slot2].get_type() == ValueType::Uninitialized) { error(); return; }
 
-		Stack.push_back(std::move(obj));
-		executable_token_index++;
+		try { if (apply_comparison((OpCode)operation, Variables[slot1], Variables[slot2])) jmp(target); }
+		catch (...) { error(); }
 	}
-	void derivative() {
+	void ji_cmp_var_const(int slot, int constant, int operation, int target) {
+		if (both_integers(Variables[slot], constants[constant])) { int_ji_cmp_var_const(slot, constant, operation, target); return; }
+		if (Variables[slot].get_type() == ValueType::Uninitialized) { error(); return; }
+
+		try { if (apply_comparison((OpCode)operation, Variables[slot], constants[constant])) jmp(target); }
+		catch (...) { error(); }
+	}
+	template <bool checked>
+	void ji_cmp_const(int constant, int operation, int target) {
 		CHECK_STACK_SIZE(1)
 
-		Object obj = std::move(Stack.back());
-		Stack.pop_back();
+		if (both_integers(Stack.back(), constants[constant])) { int_ji_cmp_const<false>(constant, operation, target); return; }
 
-		Polynomial p;
-		switch (obj.get_type()) {
-		case ValueType::Integer:    p = *(int*)       obj.get_ptr(); break;
-		case ValueType::Polynomial: p = *(Polynomial*)obj.get_ptr(); break;
+		try {
+			bool jump = apply_comparison((OpCode)operation, Stack.back(), constants[constant]);
+			Stack.pop_back();
+			if (jump) jmp(target);
 		}
+		catch (...) { error(); }
+	}
 
-		obj.set(new Polynomial(p.derivative()), ValueType::Polynomial);
+	// ---------------------------------------
+	// команды для операндов известного типа (см. Compiler::specialize) : типы не проверяются
+	// ---------------------------------------
+	template <bool checked>
+	void int_arith(int operation) {
+		CHECK_STACK_SIZE(2)
 
-		Stack.push_back(std::move(obj));
-		executable_token_index++;
+		Object& obj1 = Stack[Stack.size() - 2];
+		try {
+			obj1.replace_int(int_arithmetic((OpCode)operation, obj1.get_int(), Stack.back().get_int()));
+			Stack.pop_back();
+		}
+		catch (...) { error(); }
 	}
-
-	void atpow() {
+	template <bool checked>
+	void int_compare(int operation) {
 		CHECK_STACK_SIZE(2)
 
-		Object obj2 = std::move(Stack.back());
+		Object& obj1 = Stack[Stack.size() - 2];
+		obj1.replace_int(int_comparison((OpCode)operation, obj1.get_int(), Stack.back().get_int()));
 		Stack.pop_back();
-		Object obj1 = std::move(Stack.back());
+	}
+	template <bool checked>
+	void poly_arith(int operation) {
+		CHECK_STACK_SIZE(2)
+
+		Object& obj1 = Stack[Stack.size() - 2];
+		try {
+			obj1 = Object(polynomial_arithmetic((OpCode)operation, obj1.get_polynomial(), Stack.back().get_polynomial()));
+			Stack.pop_back();
+		}
+		catch (...) { error(); }
+	}
+	void int_arith_var_var(int slot1, int slot2, int operation) {
+		try { Stack.push_back(Object(int_arithmetic((OpCode)operation, Variables[slot1].get_int(), Variables[slot2].get_int()))); }
+		catch (...) { error(); }
+	}
+	void int_arith_var_const(int slot, int constant, int operation) {
+		try { Stack.push_back(Object(int_arithmetic((OpCode)operation, Variables[slot].get_int(), constants[constant].get_int()))); }
+		catch (...) { error(); }
+	}
+	void int_update_var_const(int slot, int constant, int operation) {
+		try { Variables[slot].replace_int(int_arithmetic((OpCode)operation, Variables[slot].get_int(), constants[constant].get_int())); }
+		catch (...) { error(); }
+	}
+	void int_ji_cmp_var_var(int slot1, int slot2, int operation, int target) {
+		if (int_comparison((OpCode)operation, Variables[slot1].get_int(), Variables[slot2].get_int())) jmp(target);
+	}
+	void int_ji_cmp_var_const(int slot, int constant, int operation, int target) {
+		if (int_comparison((OpCode)operation, Variables[slot].get_int(), constants[constant].get_int())) jmp(target);
+	}
+	template <bool checked>
+	void int_ji_cmp_const(int constant, int operation, int target) {
+		CHECK_STACK_SIZE(1)
+
+		bool jump = int_comparison((OpCode)operation, Stack.back().get_int(), constants[constant].get_int());
 		Stack.pop_back();
+		if (jump) jmp(target);
+	}
 
-		if (obj2.get_type() == ValueType::Polynomial) { error(); return; }
+	/* ошибка выполнения : сообщение и всё выведенное до него сразу записываются, не дожидаясь конца запуска */
+	void error() {
+		output.write("Ошибка во время выполнения программы...\n");
+		output.flush();
+		if (tracing && !trace_dumped) trace_dumped = dump_trace();
+		pc = bytecode.halt_offset;
+		interpreting = false;
+	}
 
-		Polynomial p;
-		switch (obj1.get_type()) {
-		case ValueType::Integer:    p = *(int*)       obj1.get_ptr(); break;
-		case ValueType::Polynomial: p = *(Polynomial*)obj1.get_ptr(); break;
+	/* процедура "исполнить команду" ; pc уже указывает на следующую команду */
+	template <bool checked>
+	void execute_instruction(const int* instruction) {
+		switch ((OpCode)instruction[0]) {
+		case OpPush:				push(instruction[1]);							break;
+		case OpPushVar:				push_variable(instruction[1]);					break;
+		case OpPop:					pop<checked>(instruction[1]);					break;
+		case OpJmp:					jmp(instruction[1]);							break;
+		case OpJi:					ji<checked>(instruction[1]);					break;
+		case OpRead:				read();											break;
+		case OpWrite:				write<checked>();								break;
+		case OpEnd:					end();											break;
+
+		case OpAdd:					calculate<checked>(OpAdd);						break;
+		case OpSub:					calculate<checked>(OpSub);						break;
+		case OpMul:					calculate<checked>(OpMul);						break;
+		case OpDiv:					calculate<checked>(OpDiv);						break;
+		case OpMod:					calculate<checked>(OpMod);						break;
+
+		case OpEqual:				compare<checked>(OpEqual);						break;
+		case OpNotEqual:			compare<checked>(OpNotEqual);					break;
+		case OpLess:				compare<checked>(OpLess);						break;
+		case OpLessOrEqual:			compare<checked>(OpLessOrEqual);				break;
+		case OpBigger:				compare<checked>(OpBigger);						break;
+		case OpBiggerOrEqual:		compare<checked>(OpBiggerOrEqual);				break;
+
+		case OpAtpow:				function_2<checked>(OpAtpow);					break;
+		case OpDeg:					function<checked>(OpDeg);						break;
+		case OpDerivative:			function<checked>(OpDerivative);				break;
+		case OpValue:				function_2<checked>(OpValue);					break;
+		case OpMVar:				function<checked>(OpMVar);						break;
+		case OpRoots:				roots<checked>();								break;
+		case OpDerivN:				function_2<checked>(OpDerivN);					break;
+		case OpShift:				function_2<checked>(OpShift);					break;
+
+		case OpFail:				error();										break;
+		case OpHalt:				end();											break;
+
+		case OpPushVarVar:			push_var_var(instruction[1], instruction[2]);	break;
+		case OpArithVarVar:			arith_var_var(instruction[1], instruction[2], instruction[3]);	break;
+		case OpArithVarConst:		arith_var_const(instruction[1], instruction[2], instruction[3]);	break;
+		case OpUpdateVarConst:		update_var_const(instruction[1], instruction[2], instruction[3]);	break;
+		case OpJiCmpVarVar:			ji_cmp_var_var(instruction[1], instruction[2], instruction[3], instruction[4]);	break;
+		case OpJiCmpVarConst:		ji_cmp_var_const(instruction[1], instruction[2], instruction[3], instruction[4]);	break;
+		case OpJiCmpConst:			ji_cmp_const<checked>(instruction[1], instruction[2], instruction[3]);	break;
+
+		case OpIntArith:			int_arith<checked>(instruction[1]);				break;
+		case OpIntCompare:			int_compare<checked>(instruction[1]);			break;
+		case OpPolyArith:			poly_arith<checked>(instruction[1]);			break;
+		case OpIntArithVarVar:		int_arith_var_var(instruction[1], instruction[2], instruction[3]);	break;
+		case OpIntArithVarConst:	int_arith_var_const(instruction[1], instruction[2], instruction[3]);	break;
+		case OpIntUpdateVarConst:	int_update_var_const(instruction[1], instruction[2], instruction[3]);	break;
+		case OpIntJiCmpVarVar:		int_ji_cmp_var_var(instruction[1], instruction[2], instruction[3], instruction[4]);	break;
+		case OpIntJiCmpVarConst:	int_ji_cmp_var_const(instruction[1], instruction[2], instruction[3], instruction[4]);	break;
+		case OpIntJiCmpConst:		int_ji_cmp_const<checked>(instruction[1], instruction[2], instruction[3]);	break;
+		case COUNT_OPCODES:			error();										break;
 		}
+	}
 
-		obj1.set(new int(p[*(int*)obj2.get_ptr()]), ValueType::Integer);
-		Stack.push_back(std::move(obj1));
-		executable_token_index++;
+	// событие трассы : команда и состояние стека перед ней
+	void trace_instruction(int offset) {
+		int types = 0;
+		if (Stack.size() >= 1) types |= (int)Stack.back().get_type() + 1;
+		if (Stack.size() >= 2) types |= ((int)Stack[Stack.size() - 2].get_type() + 1) << 3;
 
+		trace.record(offset, bytecode.code[offset], Stack.size(), types);
 	}
-	void value() {
-		CHECK_STACK_SIZE(2)
 
-		Object obj2 = std::move(Stack.back());
-		Stack.pop_back();
-		Object obj1 = std::move(Stack.back());
-		Stack.pop_back();
+	// цикл исполнения с выбором команды оператором switch (переносимый)
+	template <bool checked>
+	void run_switch() {
+		const int* code = bytecode.code.data();
+		while (interpreting) {
+			TRACE_INSTRUCTION(pc)
+			const int* instruction = code + pc;
+			pc += Bytecode::length((OpCode)instruction[0]);
+			execute_instruction<checked>(instruction);
+		}
+	}
+
+	// операнды команды, которая что-то вычисляет, --- многочлены (для профиля)
+	bool polynomial_operands(const int* instruction) const {
+		OpCode op = (OpCode)instruction[0];
+		switch (op) {
+		case OpPush: case OpPushVar: case OpPop: case OpJmp: case OpJi: case OpRead: case OpWrite: case OpEnd:
+		case OpFail: case OpHalt: case OpPushVarVar:
+			return false;
+		default:
+			break;
+		}
+
+		auto polynomial = [](const Object& obj) {
+			return obj.get_type() == ValueType::Polynomial || obj.get_type() == ValueType::Multivariate;
+		};
 
-		if (obj2.get_type() == ValueType::Polynomial) { error(); return; }
+		int inputs = std::min<int>(Bytecode::stack_inputs(op), Stack.size());
+		for (int i = 1; i <= inputs; i++) {
+			if (polynomial(Stack[Stack.size() - i])) return true;
+		}
 
-		Polynomial p;
-		switch (obj1.get_type()) {
-		case ValueType::Integer:    p = *(int*)       obj1.get_ptr(); break;
-		case ValueType::Polynomial: p = *(Polynomial*)obj1.get_ptr(); break;
+		const char* kinds = Bytecode::operand_kinds(op);
+		for (int i = 0; kinds[i]; i++) {
+			if (kinds[i] == 's' && polynomial(Variables[instruction[1 + i]])) return true;
+			if (kinds[i] == 'c' && polynomial(constants[instruction[1 + i]])) return true;
 		}
+		return false;
+	}
 
-		obj1.set(new Polynomial(p(*(int*)obj2.get_ptr())), ValueType::Polynomial);
-		Stack.push_back(std::move(obj1));
-		executable_token_index++;
+	// цикл исполнения с замером времени каждой команды
+	void run_profiling() {
+		const int* code = bytecode.code.data();
+		while (interpreting) {
+			int        offset      = pc;
+			const int* instruction = code + offset;
+			bool       kernel      = polynomial_operands(instruction);
+			TRACE_INSTRUCTION(offset)
+
+			auto start = std::chrono::steady_clock::now();
+			pc += Bytecode::length((OpCode)instruction[0]);
+			execute_instruction<true>(instruction);
+			long long elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+			profile.counts[offset]++;
+			profile.times[offset] += elapsed;
+			if (kernel) profile.kernel_times[offset] += elapsed;
+		}
 	}
 
-	void skip() {
-		executable_token_index++;
+	// цикл исполнения с подсчётом исполнений каждой команды
+	void run_counting() {
+		const int* code = bytecode.code.data();
+		while (interpreting) {
+			TRACE_INSTRUCTION(pc)
+			executed[pc]++;
+
+			const int* instruction = code + pc;
+			pc += Bytecode::length((OpCode)instruction[0]);
+			execute_instruction<true>(instruction);
+		}
 	}
-	void error() {
-		std::cout << "Ошибка во время выполнения программы...\n";
+
+#if INTERPRETER_COMPUTED_GOTO
+	/* цикл исполнения с шитым кодом : для каждого слова кода заранее записан адрес обработчика его команды,
+	*  переход к следующей команде --- один косвенный переход в конце каждого обработчика,
+	*  поэтому у каждой команды своё место предсказания перехода ; end и ошибки переводят pc на OpHalt */
+	template <bool checked>
+	void run_threaded() {
+		static const void* const labels[] = {
+			&&op_push, &&op_push_var, &&op_pop, &&op_jmp, &&op_ji, &&op_read, &&op_write, &&op_end,
+			&&op_add, &&op_sub, &&op_mul, &&op_div, &&op_mod,
+			&&op_equal, &&op_not_equal, &&op_less, &&op_less_or_equal, &&op_bigger, &&op_bigger_or_equal,
+			&&op_atpow, &&op_deg, &&op_derivative, &&op_value, &&op_mvar, &&op_roots, &&op_derivn, &&op_shift,
+			&&op_fail, &&op_halt,
+			&&op_push_var_var, &&op_arith_var_var, &&op_arith_var_const, &&op_update_var_const,
+			&&op_ji_cmp_var_var, &&op_ji_cmp_var_const, &&op_ji_cmp_const,
+			&&op_int_arith, &&op_int_compare, &&op_poly_arith,
+			&&op_int_arith_var_var, &&op_int_arith_var_const, &&op_int_update_var_const,
+			&&op_int_ji_cmp_var_var, &&op_int_ji_cmp_var_const, &&op_int_ji_cmp_const
+		};
+		static_assert(sizeof(labels) / sizeof(labels[0]) == COUNT_OPCODES, "нужен обработчик для каждой команды");
+
+		if (threaded_code.size() != bytecode.code.size() || threaded_labels != labels) {
+			threaded_labels = labels;
+			threaded_code.assign(bytecode.code.size(), nullptr);
+			for (int offset = 0; offset < bytecode.code.size(); offset += Bytecode::length((OpCode)bytecode.code[offset])) {
+				threaded_code[offset] = labels[bytecode.code[offset]];
+			}
+		}
+
+		const int*         code     = bytecode.code.data();
+		const void* const* handlers = threaded_code.data();
+		const int*         instruction;
+
+#define DISPATCH() instruction = code + pc; TRACE_INSTRUCTION(pc) goto *handlers[pc];
+#define HANDLER(label, length, action) label: pc += (length); action; DISPATCH()
+
+		DISPATCH()
+
+		HANDLER(op_push,             2, push(instruction[1]))
+		HANDLER(op_push_var,         2, push_variable(instruction[1]))
+		HANDLER(op_pop,              2, pop<checked>(instruction[1]))
+		HANDLER(op_jmp,              2, jmp(instruction[1]))
+		HANDLER(op_ji,               2, ji<checked>(instruction[1]))
+		HANDLER(op_read,             1, read())
+		HANDLER(op_write,            1, write<checked>())
+		HANDLER(op_end,              1, end())
+
+		HANDLER(op_add,              1, calculate<checked>(OpAdd))
+		HANDLER(op_sub,              1, calculate<checked>(OpSub))
+		HANDLER(op_mul,              1, calculate<checked>(OpMul))
+		HANDLER(op_div,              1, calculate<checked>(OpDiv))
+		HANDLER(op_mod,              1, calculate<checked>(OpMod))
+
+		HANDLER(op_equal,            1, compare<checked>(OpEqual))
+		HANDLER(op_not_equal,        1, compare<checked>(OpNotEqual))
+		HANDLER(op_less,             1, compare<checked>(OpLess))
+		HANDLER(op_less_or_equal,    1, compare<checked>(OpLessOrEqual))
+		HANDLER(op_bigger,           1, compare<checked>(OpBigger))
+		HANDLER(op_bigger_or_equal,  1, compare<checked>(OpBiggerOrEqual))
+
+		HANDLER(op_atpow,            1, function_2<checked>(OpAtpow))
+		HANDLER(op_deg,              1, function<checked>(OpDeg))
+		HANDLER(op_derivative,       1, function<checked>(OpDerivative))
+		HANDLER(op_value,            1, function_2<checked>(OpValue))
+		HANDLER(op_mvar,             1, function<checked>(OpMVar))
+		HANDLER(op_roots,            1, roots<checked>())
+		HANDLER(op_derivn,           1, function_2<checked>(OpDerivN))
+		HANDLER(op_shift,            1, function_2<checked>(OpShift))
+
+		HANDLER(op_fail,             1, error())
+
+		HANDLER(op_push_var_var,     3, push_var_var(instruction[1], instruction[2]))
+		HANDLER(op_arith_var_var,    4, arith_var_var(instruction[1], instruction[2], instruction[3]))
+		HANDLER(op_arith_var_const,  4, arith_var_const(instruction[1], instruction[2], instruction[3]))
+		HANDLER(op_update_var_const, 4, update_var_const(instruction[1], instruction[2], instruction[3]))
+		HANDLER(op_ji_cmp_var_var,   5, ji_cmp_var_var(instruction[1], instruction[2], instruction[3], instruction[4]))
+		HANDLER(op_ji_cmp_var_const, 5, ji_cmp_var_const(instruction[1], instruction[2], instruction[3], instruction[4]))
+		HANDLER(op_ji_cmp_const,     4, ji_cmp_const<checked>(instruction[1], instruction[2], instruction[3]))
+
+		HANDLER(op_int_arith,            2, int_arith<checked>(instruction[1]))
+		HANDLER(op_int_compare,          2, int_compare<checked>(instruction[1]))
+		HANDLER(op_poly_arith,           2, poly_arith<checked>(instruction[1]))
+		HANDLER(op_int_arith_var_var,    4, int_arith_var_var(instruction[1], instruction[2], instruction[3]))
+		HANDLER(op_int_arith_var_const,  4, int_arith_var_const(instruction[1], instruction[2], instruction[3]))
+		HANDLER(op_int_update_var_const, 4, int_update_var_const(instruction[1], instruction[2], instruction[3]))
+		HANDLER(op_int_ji_cmp_var_var,   5, int_ji_cmp_var_var(instruction[1], instruction[2], instruction[3], instruction[4]))
+		HANDLER(op_int_ji_cmp_var_const, 5, int_ji_cmp_var_const(instruction[1], instruction[2], instruction[3], instruction[4]))
+		HANDLER(op_int_ji_cmp_const,     4, int_ji_cmp_const<checked>(instruction[1], instruction[2], instruction[3]))
+
+	op_halt:
 		interpreting = false;
+		return;
+
+#undef HANDLER
+#undef DISPATCH
 	}
+#endif
 
-	/* процедура "обработать лексему" --- исполняет очередную лексему */
-	void execute_token(Token token) {
-		switch (token.token_class) {
-		case Push:  		push(token.value); 				  break;
-		case Pop:   		pop(token.value);  				  break;
-		case Jmp:   		jmp(token.value);  				  break;
-		case Ji:    		ji(token.value);   				  break;
-		case Read:  		read();            				  break;
-		case Write: 		write();           				  break;
-		case End:			end();             				  break;
-		case ArithmeticOp:  calculate(token.value); 		  break;
-		case CmpOp:			compare((CmpValue)token.value);   break;
-		case Comment:		skip();                 		  break;
-		case Error:			error(); 						  break;
-		case EndOfFile:		end();  						  break;
-
-		case Atpow:			atpow(); 						  break;
-		case Deg:			deg();  						  break;
-		case Derivative:	derivative(); 					  break;
-		case Value:			value(); 						  break;
+	// начальное состояние : пустой стек, переменные без значений, первая команда
+	void start() {
+		Stack.clear();
+		if (program->stack_check.verified) Stack.reserve(program->stack_check.max_depth);
+		Variables.assign(bytecode.slot_names.size(), Object::uninitialized());
+
+		pc = 0;
+		interpreting = true;
+	}
+
+	// исполнение с текущего состояния в выбранном режиме до конца программы
+	void execute() {
+		if (counting) {
+			run_counting();
+		}
+		else if (profiling) {
+			run_profiling();
+		}
+#if INTERPRETER_COMPUTED_GOTO
+		else if (dispatch_mode == DispatchMode::Threaded) {
+			if (stack_checks) run_threaded<true>();
+			else              run_threaded<false>();
+		}
+#endif
+		else {
+			if (stack_checks) run_switch<true>();
+			else              run_switch<false>();
 		}
+
+		output.flush();
 	}
 public:
-	Interpreter(ParsedProgram&& _program) : program(std::move(_program)) {}
+	Interpreter(const ParsedProgram& parsed) : Interpreter(Compiler::compile(parsed)) {}
+	Interpreter(Bytecode&& _bytecode) : Interpreter(std::make_shared<const CompiledProgram>(std::move(_bytecode))) {}
+	Interpreter(std::shared_ptr<const CompiledProgram> _program)
+		: program(std::move(_program)), bytecode(program->bytecode), counting(false), profiling(false), threaded_labels(nullptr),
+		  tracing(false), trace_flags(0), trace_dumped(false), record_arena(RECORD_ARENA_BLOCK, RECORD_ARENA_LIMIT) {
+		dispatch_mode = INTERPRETER_COMPUTED_GOTO ? DispatchMode::Threaded : DispatchMode::Switch;
+
+		constants.reserve(bytecode.constants.size());
+		for (const Object& constant : bytecode.constants) constants.push_back(constant.clone());
+
+		input.tie(&output);
+
+		stack_checks = !program->stack_check.verified;
+	}
+
+	void set_dispatch_mode(DispatchMode mode) {
+		dispatch_mode = INTERPRETER_COMPUTED_GOTO ? mode : DispatchMode::Switch;
+	}
+	DispatchMode get_dispatch_mode() const {
+		return dispatch_mode;
+	}
+
+	/* режим подсчёта : исполнения команд считаются (цикл switch), счётчики накапливаются между запусками ;
+	*  по счётчикам add_sequence_counts находит частые последовательности команд */
+	void set_counting(bool _counting) {
+		counting = _counting;
+		executed.assign(bytecode.code.size(), 0);
+	}
+
+	/* режим профилирования : время каждой команды замеряется (цикл switch с проверками стека) ;
+	*  профиль накапливается между запусками, отчёт по нему строит Profiler */
+	void set_profiling(bool _profiling) {
+		profiling = _profiling;
+		profile.reset(bytecode.code.size());
+	}
+	const ExecutionProfile& get_profile() const {
+		return profile;
+	}
+
+	/* трассировка : перед каждой командой в кольцевой буфер записывается событие (см. TraceEvent) ;
+	*  буфер записывается в filename при первой ошибке выполнения или вызовом dump_trace ;
+	*  compile_flags --- с какими параметрами скомпилирована программа (для trace_decode)
+	*
+	*  события записываются, только если интерпретатор собран с INTERPRETER_TRACE 1 */
+	void set_tracing(const std::string& filename, int compile_flags, std::size_t capacity = TraceBuffer::DEFAULT_CAPACITY) {
+		tracing      = true;
+		trace_file   = filename;
+		trace_flags  = compile_flags;
+		trace_dumped = false;
+		trace.reset(capacity);
+	}
+	// запись трассы в файл, если она ещё не записана при ошибке ; false, если файл не удалось записать
+	bool dump_trace() {
+		if (!tracing || trace_dumped) return true;
+		return trace.dump(trace_file.c_str(), trace_flags, bytecode.code.size());
+	}
+
+	/* добавить к counts последовательности из 2 ... 4 соседних команд, начинающиеся с каждой исполненной команды ;
+	*  последовательность обрывается перед командой, на которую есть переход, и после команды перехода,
+	*  т. е. учитываются только последовательности, которые можно слить в суперкоманду */
+	void add_sequence_counts(SequenceCounts& counts) const {
+		const std::vector<int>& code = bytecode.code;
+
+		std::vector<bool> jump_target(code.size() + 1, false);
+		std::vector<int>  offsets;
+		for (int offset = 0; offset < code.size(); offset += Bytecode::length((OpCode)code[offset])) {
+			offsets.push_back(offset);
+
+			const char* kinds = Bytecode::operand_kinds((OpCode)code[offset]);
+			for (int i = 0; kinds[i]; i++) {
+				if (kinds[i] == 't') jump_target[code[offset + 1 + i]] = true;
+			}
+		}
+
+		auto instruction_name = [&](int offset) {
+			switch ((OpCode)code[offset]) {
+			case OpPush:    return std::string("push const");
+			case OpPushVar: return std::string("push var");
+			default:        return std::string(Bytecode::name((OpCode)code[offset]));
+			}
+		};
+		auto ends_sequence = [&](int offset) {
+			OpCode op = (OpCode)code[offset];
+			return std::strchr(Bytecode::operand_kinds(op), 't') || op == OpEnd || op == OpFail || op == OpHalt;
+		};
+
+		for (int i = 0; i < offsets.size(); i++) {
+			long long count = counting ? executed[offsets[i]] : 0;
+			if (count == 0 || ends_sequence(offsets[i])) continue;
+
+			std::string sequence = instruction_name(offsets[i]);
+			for (int length = 2; length <= 4 && i + length - 1 < offsets.size(); length++) {
+				int offset = offsets[i + length - 1];
+				if (jump_target[offset]) break;
+
+				sequence += " / " + instruction_name(offset);
+				counts[sequence] += count;
+
+				if (ends_sequence(offset)) break;
+			}
+		}
+	}
+
+	/* проверка размера стека во время выполнения ; отключить её можно только для программы,
+	*  прошедшей проверку стека (по умолчанию проверка отключается для всех таких программ) */
+	void set_stack_checks(bool _stack_checks) {
+		stack_checks = _stack_checks || !program->stack_check.verified;
+	}
+	bool get_stack_checks() const {
+		return stack_checks;
+	}
+	const StackCheck& get_stack_check() const {
+		return program->stack_check;
+	}
+
+	/* ввод и вывод программы : по умолчанию --- дескрипторы 0 и 1 (см. InputBuffer, OutputBuffer) ;
+	*  вывод записывается в конце каждого запуска и перед ожиданием ввода */
+	InputBuffer& get_input() {
+		return input;
+	}
+	OutputBuffer& get_output() {
+		return output;
+	}
+
+	// байт-код (для вывода листинга)
+	const Bytecode& get_bytecode() const {
+		return bytecode;
+	}
+	// программа (для запуска в других интерпретаторах)
+	const std::shared_ptr<const CompiledProgram>& get_program() const {
+		return program;
+	}
+
+	/* исполнение программы с начала ; стек и переменные предыдущего запуска очищаются */
 	void run() {
-		executable_token_index = 0;
+		start();
+		execute();
+	}
+
+	/* исполнение с начала до команды со смещением stop_offset (она не исполняется) ; true, если исполнение
+	*  до неё дошло, false --- программа закончилась или остановлена ошибкой раньше ;
+	*  команды исполняются с проверками стека, режимы подсчёта и профилирования не действуют */
+	bool run_until(int stop_offset) {
+		start();
+
+		const int* code = bytecode.code.data();
+		while (interpreting && pc != stop_offset) {
+			TRACE_INSTRUCTION(pc)
+			const int* instruction = code + pc;
+			pc += Bytecode::length((OpCode)instruction[0]);
+			execute_instruction<true>(instruction);
+		}
+
+		output.flush();
+		return interpreting;
+	}
+
+	// снимок текущего состояния (обычно после run_until)
+	InterpreterSnapshot snapshot() const {
+		return InterpreterSnapshot{ Stack, Variables, pc };
+	}
+
+	/* продолжение исполнения с состояния снимка ; снимок не изменяется, поэтому из одного снимка
+	*  можно запускаться много раз (снимок должен быть сделан для этой же программы) */
+	void resume(const InterpreterSnapshot& snapshot) {
+		Stack = snapshot.stack;
+		if (program->stack_check.verified) Stack.reserve(program->stack_check.max_depth);
+		Variables = snapshot.variables;
+
+		pc = snapshot.pc;
 		interpreting = true;
 
-		while (interpreting) {
-			execute_token(program.tokens[executable_token_index]);
+		execute();
+	}
+
+	/* арена записи : блок и предел памяти ; сверх предела многочлены записи размещаются как обычно */
+	static const std::size_t RECORD_ARENA_BLOCK = 1 << 20;
+	static const std::size_t RECORD_ARENA_LIMIT = 16 << 20;
+
+	/* пакетный режим : запуск на одной записи ввода (read читает значения из записи) с начала программы
+	*  или с состояния снимка start ; возвращаются все выведенные значения в одной строке через separator
+	*  (сообщение об ошибке выполнения --- последнее значение строки)
+	*
+	*  многочлены записи размещаются в арене интерпретатора, которая после записи освобождается целиком ;
+	*  поэтому стек и переменные очищаются до выхода из области арены */
+	std::string run_record(const std::string& record, char separator, const InterpreterSnapshot* start = nullptr) {
+		std::string result;
+
+		input.open_string(record);
+		output.capture(&result);
+		{
+			PolynomialArena::Scope scope(record_arena);
+
+			if (start) resume(*start);
+			else       run();
+
+			Stack.clear();
+			Variables.clear();
 		}
+		record_arena.reset();
+		output.capture(nullptr);
+
+		if (!result.empty() && result.back() == '\n') result.pop_back();
+		std::replace(result.begin(), result.end(), '\n', separator);
+		return result;
 	}
-};
\ No newline at end of file
+};
@@ -1,30 +1,20 @@
 #include <iostream>
-#include "interpreter.cpp"
+#include <cstdlib>
+#include <cstring>
+#include "executor.cpp"
+#include "polynomial_alloc.hpp"
 
-/* 	программа анализирует файл с программой и создаёт три файла, в которые записывается результат:
-*
-*	pinput_raw    :    полный список обнаруженных лексем и таблица переменных
-*
-*   pinput_exe    :    список лексем, которые могут быть исполнены интерпретатором 
-*   				   с указанием имён переменных и констант, на которые ссылаются некоторые лексмеы,
-*   				   также в конце записывается таблица переменных
-*
-*   pinput_err    :    список номеров строк, в которых найдены ошибки
-*
-*   если программа корректная, то она интерпретируется
-*/
-int main(int argc, char* argv[]) {
-	if (argc < 2) {
-		std::cout << "Нужен файл для трансляции...\n";
-		return 1;
-	}
-
-	/* запуск лексичского анализатора */
-	Parser parser;
-	ParsedProgram program = parser.run(argv[1]);
+// разделитель из параметра запуска
+static char parse_delimiter(const char* text) {
+	if (std::strcmp(text, "\\n") == 0) return '\n';
+	if (std::strcmp(text, "\\t") == 0) return '\t';
+	return text[0] ? text[0] : '\n';
+}
 
+// запись pinput_raw, pinput_exe и pinput_err ; возвращается количество ошибок
+static int write_listings(ParsedProgram& program, std::ofstream& fout) {
 	/* запись всех лексем и таблицы имён */
-	std::ofstream fout("pinput_raw");
+	fout.open("pinput_raw");
 
 	program.print_tokens(fout);
 	fout << std::endl;
@@ -53,14 +43,310 @@ int main(int argc, char* argv[]) {
 
 	fout.close();
 
-	/* интрерпретация */
-	if (errors_count != 0) {
+	return errors_count;
+}
+
+/* 	программа анализирует файл с программой и создаёт файлы, в которые записывается результат:
+*
+*	pinput_raw    :    полный список обнаруженных лексем и таблица переменных
+*
+*   pinput_exe    :    список лексем, которые могут быть исполнены интерпретатором 
+*   				   с указанием имён переменных и констант, на которые ссылаются некоторые лексмеы,
+*   				   также в конце записывается таблица переменных
+*
+*   pinput_err    :    список номеров строк, в которых найдены ошибки ; для программы без ошибок ---
+*                      ещё и результат проверки стека (строки, где командам не хватит операндов)
+*
+*   pinput_bc     :    листинг байт-кода, в который компилируется программа (только для программы без ошибок)
+*
+*   pinput_opt    :    листинг кода после оптимизации, но до слияния команд в суперкоманды
+*                      (только с параметром --dump-optimized)
+*
+*   pinput_prof   :    исполняемые лексемы с количеством исполнений, временем и долей общего времени,
+*                      время операций над многочленами (только с параметром --profile)
+*
+*   pinput_folded :    свёрнутые стеки для flame graph : "программа;строка;операция время" (только с --profile)
+*
+*   pinput_trace  :    последние исполненные команды в двоичном виде (только с --trace, см. trace_decode.cpp)
+*
+*   pinput_snap   :    снимок состояния интерпретатора (только с --snapshot-at, см. snapshot.cpp)
+*
+*   если программа корректная, то она интерпретируется
+*
+*	параметры запуска : ./main.exe [параметры] <файл>
+*	   --alloc-stats  :    после интерпретации вывести в stderr счётчики выделения памяти под многочлены
+*	   --dispatch=switch, --dispatch=threaded
+*	                  :    способ выбора команд интерпретатором (по умолчанию --- шитый код, если он поддерживается)
+*	   --profile-sequences
+*	                  :    исполнить программу без суперкоманд, подсчитывая команды, и вывести в stderr
+*	                       последовательности команд, которые выгоднее всего слить в суперкоманды
+*	   --no-optimize  :    не оптимизировать код (свёртка констант, сокращение переходов, удаление недостижимого кода)
+*	   --dump-optimized
+*	                  :    записать pinput_opt
+*	   --no-specialize
+*	                  :    не заменять команды командами для чисел и многочленов (по выведенным типам операндов)
+*	   --profile      :    исполнить программу без суперкоманд, замеряя время каждой команды, и записать
+*	                       pinput_prof и pinput_folded
+*	   --trace        :    записать последние исполненные команды в pinput_trace (при ошибке выполнения или в конце работы) ;
+*	                       только для интерпретатора, собранного с -DINTERPRETER_TRACE=1 ; трассу выводит trace_decode
+*	   --trace-events=N
+*	                  :    сколько последних команд хранить в трассе (по умолчанию 65536)
+*	   --stack-checks :    проверять размер стека во время выполнения и для программы, прошедшей проверку стека
+*	   --input-fd=N, --output-fd=N
+*	                  :    дескрипторы файлов, из которых программа читает (read) и в которые пишет (write) ;
+*	                       по умолчанию --- 0 и 1
+*	   --batch        :    пакетный режим : программа разбирается один раз и исполняется на каждой записи ввода
+*	                       (значения для read берутся из записи) ; выведенные на одной записи значения
+*	                       записываются одной строкой через разделитель полей
+*	   --record-delimiter=C, --field-delimiter=C
+*	                  :    разделитель записей ввода (по умолчанию --- перевод строки) и разделитель значений
+*	                       в строке результата (по умолчанию --- табуляция) ; можно писать \n и \t
+*	   --threads=N    :    пакетный режим в N потоках (0 --- по количеству ядер) ; результаты выводятся в порядке записей
+*	   --cache        :    взять байт-код из <файл>.sbc, если он записан для того же исходного текста и тех же
+*	                       параметров компиляции, иначе скомпилировать программу и записать <файл>.sbc ;
+*	                       байт-код из кэша исполняется сразу, файлы pinput_* при этом не записываются
+*	   --snapshot-at=N
+*	                  :    исполнить программу до первой команды строки N (номер строки --- как в pinput_bc)
+*	                       и записать снимок стека, переменных и смещения команды ; без --batch программа
+*	                       на этом останавливается, с --batch каждая запись исполняется со снимка
+*	                       (строки до N исполняются один раз ; read в них --- ошибка)
+*	   --snapshot-file=F
+*	                  :    файл для снимка (по умолчанию pinput_snap)
+*	   --restore=F    :    продолжить исполнение со снимка из файла F (с --batch --- каждую запись) ;
+*	                       снимок подходит только для того же байт-кода (те же программа и параметры компиляции)
+*/
+int main(int argc, char* argv[]) {
+	const char* filename = nullptr;
+	bool alloc_stats = false;
+	bool switch_dispatch = false;
+	bool profile_sequences = false;
+	bool profile = false;
+	bool trace = false;
+	bool cache = false;
+	long trace_events = TraceBuffer::DEFAULT_CAPACITY;
+	bool optimize_code = true;
+	bool dump_optimized = false;
+	bool stack_checks = false;
+	bool specialize_types = true;
+	int input_fd = 0;
+	int output_fd = 1;
+	bool batch = false;
+	char record_delimiter = '\n';
+	char field_delimiter = '\t';
+	int count_threads = 1;
+	int snapshot_line = -1;
+	const char* snapshot_file = "pinput_snap";
+	const char* restore_file = nullptr;
+
+	for (int i = 1; i < argc; ++i) {
+		if      (std::strcmp(argv[i], "--alloc-stats") == 0)       alloc_stats = true;
+		else if (std::strcmp(argv[i], "--dispatch=switch") == 0)   switch_dispatch = true;
+		else if (std::strcmp(argv[i], "--dispatch=threaded") == 0) switch_dispatch = false;
+		else if (std::strcmp(argv[i], "--profile-sequences") == 0) profile_sequences = true;
+		else if (std::strcmp(argv[i], "--profile") == 0)           profile = true;
+		else if (std::strcmp(argv[i], "--trace") == 0)             trace = true;
+		else if (std::strcmp(argv[i], "--cache") == 0)             cache = true;
+		else if (std::strncmp(argv[i], "--trace-events=", 15) == 0) trace_events = std::atol(argv[i] + 15);
+		else if (std::strcmp(argv[i], "--no-optimize") == 0)       optimize_code = false;
+		else if (std::strcmp(argv[i], "--dump-optimized") == 0)    dump_optimized = true;
+		else if (std::strcmp(argv[i], "--stack-checks") == 0)      stack_checks = true;
+		else if (std::strcmp(argv[i], "--no-specialize") == 0)     specialize_types = false;
+		else if (std::strncmp(argv[i], "--input-fd=", 11) == 0)    input_fd = std::atoi(argv[i] + 11);
+		else if (std::strncmp(argv[i], "--output-fd=", 12) == 0)   output_fd = std::atoi(argv[i] + 12);
+		else if (std::strcmp(argv[i], "--batch") == 0)             batch = true;
+		else if (std::strncmp(argv[i], "--record-delimiter=", 19) == 0) record_delimiter = parse_delimiter(argv[i] + 19);
+		else if (std::strncmp(argv[i], "--field-delimiter=", 18) == 0)  field_delimiter = parse_delimiter(argv[i] + 18);
+		else if (std::strncmp(argv[i], "--threads=", 10) == 0)     count_threads = std::atoi(argv[i] + 10);
+		else if (std::strncmp(argv[i], "--snapshot-at=", 14) == 0) snapshot_line = std::atoi(argv[i] + 14);
+		else if (std::strncmp(argv[i], "--snapshot-file=", 16) == 0) snapshot_file = argv[i] + 16;
+		else if (std::strncmp(argv[i], "--restore=", 10) == 0)     restore_file = argv[i] + 10;
+		else 													   filename = argv[i];
+	}
+
+	if (!filename) {
+		std::cout << "Нужен файл для трансляции...\n";
+		return 1;
+	}
+
+	bool fuse_sequences = !profile_sequences && !profile;
+	int  flags          = compile_flags(fuse_sequences, optimize_code, specialize_types);
+
+	/* кэш скомпилированной программы : если исходный текст и параметры компиляции те же,
+	*  программа не разбирается и не компилируется (нужные для --profile и --dump-optimized лексемы не читаются из кэша) */
+	std::string source;
+	std::string cache_filename = ProgramCache::filename_for(filename);
+	bool use_cache = cache && !profile && !dump_optimized && ProgramCache::read_file(filename, source);
+
+	Bytecode cached_bytecode;
+	bool cached = use_cache && ProgramCache::load(cache_filename, source, flags, cached_bytecode);
+
+	/* запуск лексичского анализатора */
+	Parser parser;
+	ParsedProgram program = cached ? ParsedProgram(filename) : parser.run(filename);
+
+	std::ofstream fout;
+	if (!cached && write_listings(program, fout) != 0) {
 		std::cout << "Программа содержит ошибки...\nНомера строк с ошибками можно посмотреть в файле 'pinput_err'" << std::endl;
 		return 0;
 	}
 
-	Interpreter interpreter(std::move(program));
-	interpreter.run();
-	
+	TermAllocator::reset_stats();
+
+	Interpreter interpreter(cached ? std::move(cached_bytecode) : Compiler::compile(program, fuse_sequences, optimize_code, specialize_types));
+	if (use_cache && !cached && !ProgramCache::save(cache_filename, interpreter.get_bytecode(), source, flags)) {
+		std::cerr << "Не удалось записать кэш программы в " << cache_filename << '\n';
+	}
+	if (switch_dispatch)   interpreter.set_dispatch_mode(DispatchMode::Switch);
+	if (profile_sequences) interpreter.set_counting(true);
+	if (profile)           interpreter.set_profiling(true);
+	if (trace) {
+		if (!INTERPRETER_TRACE) std::cerr << "Интерпретатор собран без трассировки (нужен -DINTERPRETER_TRACE=1) : трасса будет пустой\n";
+
+		interpreter.set_tracing("pinput_trace", flags, trace_events > 0 ? trace_events : 1);
+	}
+	if (stack_checks)      interpreter.set_stack_checks(true);
+	interpreter.get_input().bind(input_fd);
+	interpreter.get_output().bind(output_fd);
+
+	if (!cached) {
+		/* запись результата проверки стека */
+		fout.open("pinput_err", std::ios::app);
+
+		interpreter.get_stack_check().print(fout);
+
+		fout.close();
+
+		/* запись байт-кода */
+		fout.open("pinput_bc");
+
+		interpreter.get_bytecode().print(fout);
+
+		fout.close();
+	}
+
+	/* запись оптимизированного кода без суперкоманд */
+	if (dump_optimized) {
+		fout.open("pinput_opt");
+
+		Compiler::compile(program, false, optimize_code, false).print(fout);
+
+		fout.close();
+	}
+
+	/* снимок состояния : с него начинается исполнение (в пакетном режиме --- каждой записи) */
+	InterpreterSnapshot start;
+	bool from_snapshot = false;
+	if (snapshot_line >= 0) {
+		int stop_offset = interpreter.get_bytecode().line_offset(snapshot_line);
+		if (stop_offset < 0) {
+			std::cout << "Строка " << snapshot_line << " не начинает команду байт-кода (см. pinput_bc)...\n";
+			return 1;
+		}
+		/* в пакетном режиме ввод --- записи : строки до снимка читают пустую строку, и read в них --- ошибка
+		*  (иначе буфер ввода интерпретатора забрал бы часть записей) */
+		if (batch) interpreter.get_input().open_string("");
+
+		if (!interpreter.run_until(stop_offset)) {
+			std::cout << "Программа завершилась до строки " << snapshot_line << "...\n";
+			if (batch) std::cout << "В пакетном режиме строки до снимка не могут читать ввод (read)...\n";
+			return 1;
+		}
+
+		start = interpreter.snapshot();
+		from_snapshot = batch;
+		if (!SnapshotImage::save(snapshot_file, interpreter.get_bytecode(), start)) {
+			std::cerr << "Не удалось записать снимок в " << snapshot_file << '\n';
+		}
+	}
+	else if (restore_file) {
+		if (!SnapshotImage::load(restore_file, *interpreter.get_program(), start)) {
+			std::cout << "Снимок " << restore_file << " не прочитан или записан для другой программы...\n";
+			return 1;
+		}
+		from_snapshot = true;
+	}
+
+	if (batch && count_threads != 1 && !profile_sequences && !profile && !trace) {
+		/* пакетный режим в нескольких потоках : записи читаются блоками, блок исполняется параллельно */
+		const std::size_t BLOCK_RECORDS = 1 << 14;
+
+		ParallelExecutor executor(interpreter.get_program(), count_threads);
+		if (switch_dispatch) executor.set_dispatch_mode(DispatchMode::Switch);
+		if (stack_checks)    executor.set_stack_checks(true);
+
+		InputBuffer  records(input_fd);
+		OutputBuffer results(output_fd);
+		records.tie(&results);
+
+		std::vector<std::string> block;
+		std::string record;
+		bool more = true;
+		while (more) {
+			block.clear();
+			while (block.size() < BLOCK_RECORDS && (more = records.read_record(record, record_delimiter))) {
+				block.push_back(record);
+			}
+
+			for (const std::string& result : executor.run_records(block, field_delimiter, from_snapshot ? &start : nullptr)) {
+				results.write(result);
+				results.write('\n');
+			}
+		}
+	}
+	else if (batch) {
+		/* пакетный режим : стек и переменные очищаются (или берутся из снимка) перед каждой записью */
+		InputBuffer  records(input_fd);
+		OutputBuffer results(output_fd);
+		records.tie(&results);
+
+		std::string record;
+		while (records.read_record(record, record_delimiter)) {
+			results.write(interpreter.run_record(record, field_delimiter, from_snapshot ? &start : nullptr));
+			results.write('\n');
+		}
+	}
+	else if (from_snapshot) {
+		interpreter.resume(start);
+	}
+	else if (snapshot_line < 0) {
+		interpreter.run();
+	}
+
+	/* запись трассы (если она не записана при ошибке) */
+	if (trace && !interpreter.dump_trace()) {
+		std::cerr << "Не удалось записать трассу в pinput_trace\n";
+	}
+
+	/* запись профиля */
+	if (profile) {
+		fout.open("pinput_prof");
+
+		Profiler::print_listing(program, interpreter.get_bytecode(), interpreter.get_profile(), fout);
+
+		fout.close();
+
+		fout.open("pinput_folded");
+
+		Profiler::print_folded(program, interpreter.get_bytecode(), interpreter.get_profile(), fout);
+
+		fout.close();
+	}
+
+	if (profile_sequences) {
+		SequenceCounts counts;
+		interpreter.add_sequence_counts(counts);
+		print_sequence_counts(counts, std::cerr);
+	}
+
+	if (alloc_stats) {
+		AllocationStats stats = TermAllocator::stats();
+		std::cerr << "Выделений памяти под термы:       " << stats.allocations        << '\n'
+				  << "  из списков свободных блоков:    " << stats.pool_hits          << '\n'
+				  << "  из арены:                       " << stats.arena_allocations  << '\n'
+				  << "Обращений к системе:              " << stats.system_allocations << '\n'
+				  << "Байт получено у системы:          " << stats.system_bytes       << '\n'
+				  << "Освобождений:                     " << stats.deallocations      << '\n';
+	}
+
 	return 0;
 }
\ No newline at end of file
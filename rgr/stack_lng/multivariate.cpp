@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <queue>
+#include "multivariate.hpp"
+
+static const MultiPolynomial::Monomial GUARD_BITS = 0x8080808080808080ull;	// старшие биты байтов-показателей
+
+static int shift_of(int variable) {
+	return 8 * (MultiPolynomial::MAX_VARIABLES - 1 - variable);
+}
+
+MultiPolynomial::Monomial MultiPolynomial::monomial(const int* powers, int count) {
+	if (count > MAX_VARIABLES) throw 1;
+
+	Monomial m = 0;
+	for (int variable = 0; variable < count; variable++) {
+		if (powers[variable] < 0 || powers[variable] > MAX_POWER) throw 1;
+
+		m |= (Monomial)powers[variable] << shift_of(variable);
+	}
+
+	return m;
+}
+int MultiPolynomial::power(Monomial m, int variable) {
+	return (m >> shift_of(variable)) & 0xFF;
+}
+
+MultiPolynomial::Monomial MultiPolynomial::multiply_monomials(Monomial m1, Monomial m2) {
+	// показатели не больше 127, поэтому сумма байтов не переносится в соседний байт
+	Monomial prod = m1 + m2;
+	if (prod & GUARD_BITS) throw 1;
+
+	return prod;
+}
+
+MultiPolynomial::MultiPolynomial() {}
+
+MultiPolynomial::MultiPolynomial(float coeff) {
+	if (coeff != 0) Terms.push_back({ 0, coeff });
+}
+MultiPolynomial::MultiPolynomial(Monomial m, float coeff) {
+	if (coeff != 0) Terms.push_back({ m, coeff });
+}
+
+MultiPolynomial::MultiPolynomial(const Monomial* monomials, const float* coeffs, int count) {
+	Terms.reserve(count);
+	for (int i = 0; i < count; i++) Terms.push_back({ monomials[i], coeffs[i] });
+}
+
+MultiPolynomial::MultiPolynomial(const Polynomial& polynomial, int variable) {
+	if (variable < 0 || variable >= MAX_VARIABLES) throw 1;
+
+	struct PowerCoeff { int power; float coefficient; };
+	std::vector<PowerCoeff> sorted;
+	for (auto& _term : polynomial) {
+		sorted.push_back({ _term.power, _term.coefficient });
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const PowerCoeff& a, const PowerCoeff& b) { return a.power > b.power; });
+
+	// при повторе степени учитывается первый терм, как в Polynomial::operator[]
+	int powers[MAX_VARIABLES] = {};
+	for (int i = 0; i < sorted.size(); i++) {
+		if (i > 0 && sorted[i].power == sorted[i - 1].power) continue;
+
+		powers[variable] = sorted[i].power;
+		Terms.push_back({ monomial(powers, MAX_VARIABLES), sorted[i].coefficient });
+	}
+
+	Terms.erase(std::remove_if(Terms.begin(), Terms.end(), [](const Term& t) { return t.coefficient == 0; }), Terms.end());
+}
+
+MultiPolynomial MultiPolynomial::variable(int index) {
+	if (index < 0 || index >= MAX_VARIABLES) throw 1;
+
+	return MultiPolynomial((Monomial)1 << shift_of(index), 1.0f);
+}
+
+int MultiPolynomial::count_terms() const {
+	return Terms.size();
+}
+MultiPolynomial::Monomial MultiPolynomial::term_monomial(int index) const {
+	return Terms[index].monomial;
+}
+float MultiPolynomial::term_coefficient(int index) const {
+	return Terms[index].coefficient;
+}
+
+int MultiPolynomial::deg() const {
+	int max_power = 0, term_power;
+
+	for (const Term& _term : Terms) {
+		term_power = 0;
+		for (int variable = 0; variable < MAX_VARIABLES; variable++) {
+			term_power += power(_term.monomial, variable);
+		}
+
+		if (term_power > max_power) max_power = term_power;
+	}
+
+	return max_power;
+}
+
+int MultiPolynomial::single_variable() const {
+	Monomial used = 0;
+	for (const Term& _term : Terms) {
+		used |= _term.monomial;
+	}
+
+	int found = 0, count_found = 0;
+	for (int variable = 0; variable < MAX_VARIABLES; variable++) {
+		if (power(used, variable) == 0) continue;
+
+		found = variable;
+		count_found++;
+	}
+
+	return count_found <= 1 ? found : -1;
+}
+
+float MultiPolynomial::operator ()(const float* values) const {
+	float eval = 0;
+	float term_value;
+
+	for (const Term& _term : Terms) {
+		term_value = _term.coefficient;
+		for (int variable = 0; variable < MAX_VARIABLES; variable++) {
+			for (int i = power(_term.monomial, variable); i > 0; i--) {
+				term_value *= values[variable];
+			}
+		}
+
+		eval += term_value;
+	}
+
+	return eval;
+}
+
+float MultiPolynomial::operator [](Monomial m) const {
+	// термы упорядочены по убыванию одночленов
+	auto it = std::lower_bound(Terms.begin(), Terms.end(), m, [](const Term& t, Monomial key) { return t.monomial > key; });
+	if (it == Terms.end() || it->monomial != m) return 0;
+
+	return it->coefficient;
+}
+
+MultiPolynomial MultiPolynomial::operator +(const MultiPolynomial& added) const {
+	MultiPolynomial sum;
+	sum.Terms.reserve(Terms.size() + added.Terms.size());
+
+	// слияние упорядоченных списков термов
+	int i = 0, j = 0;
+	float pow_coeff;
+	while (i < Terms.size() && j < added.Terms.size()) {
+		if (Terms[i].monomial > added.Terms[j].monomial) {
+			sum.Terms.push_back(Terms[i++]);
+		}
+		else if (Terms[i].monomial < added.Terms[j].monomial) {
+			sum.Terms.push_back(added.Terms[j++]);
+		}
+		else {
+			pow_coeff = Terms[i].coefficient + added.Terms[j].coefficient;
+			if (pow_coeff != 0) sum.Terms.push_back({ Terms[i].monomial, pow_coeff });
+			i++; j++;
+		}
+	}
+	sum.Terms.insert(sum.Terms.end(), Terms.begin() + i, Terms.end());
+	sum.Terms.insert(sum.Terms.end(), added.Terms.begin() + j, added.Terms.end());
+
+	return sum;
+}
+
+MultiPolynomial MultiPolynomial::operator -() const {
+	MultiPolynomial negative(*this);
+	for (Term& _term : negative.Terms) {
+		_term.coefficient = -_term.coefficient;
+	}
+	return negative;
+}
+MultiPolynomial MultiPolynomial::operator -(const MultiPolynomial& subbed) const {
+	return *this + (-subbed);
+}
+
+MultiPolynomial MultiPolynomial::operator *(const MultiPolynomial& multed) const {
+	MultiPolynomial prod;
+	if (Terms.empty() || multed.Terms.empty()) return prod;
+
+	/* умножение с кучей : для каждого терма меньшего множителя в куче лежит очередное произведение
+	*  с термом большего множителя ; произведения извлекаются по убыванию одночленов,
+	*  поэтому одинаковые одночлены идут подряд и сразу складываются */
+	const std::vector<Term>& small = Terms.size() <= multed.Terms.size() ? Terms : multed.Terms;
+	const std::vector<Term>& large = Terms.size() <= multed.Terms.size() ? multed.Terms : Terms;
+
+	struct HeapEntry {
+		Monomial monomial;
+		int      small_index;
+		int      large_index;
+
+		bool operator <(const HeapEntry& other) const { return monomial < other.monomial; }
+	};
+
+	std::vector<HeapEntry> storage;
+	storage.reserve(small.size());
+	std::priority_queue<HeapEntry> heap(std::less<HeapEntry>(), std::move(storage));
+	for (int i = 0; i < small.size(); i++) {
+		heap.push({ multiply_monomials(small[i].monomial, large[0].monomial), i, 0 });
+	}
+
+	Monomial current;
+	float    pow_coeff;
+	while (!heap.empty()) {
+		current = heap.top().monomial;
+		pow_coeff = 0;
+
+		while (!heap.empty() && heap.top().monomial == current) {
+			HeapEntry entry = heap.top();
+			heap.pop();
+
+			pow_coeff += small[entry.small_index].coefficient * large[entry.large_index].coefficient;
+
+			if (++entry.large_index < large.size()) {
+				entry.monomial = multiply_monomials(small[entry.small_index].monomial, large[entry.large_index].monomial);
+				heap.push(entry);
+			}
+		}
+
+		if (pow_coeff != 0) prod.Terms.push_back({ current, pow_coeff });
+	}
+
+	return prod;
+}
+
+int MultiPolynomial::common_variable(const MultiPolynomial& other) const {
+	int variable = single_variable(), other_variable = other.single_variable();
+	if (variable < 0 || other_variable < 0) throw 1;
+
+	// постоянный многочлен подходит к любой переменной
+	if (deg() == 0)       variable = other_variable;
+	if (other.deg() == 0) other_variable = variable;
+	if (variable != other_variable) throw 1;
+
+	return variable;
+}
+
+Polynomial MultiPolynomial::univariate(int variable) const {
+	std::vector<int>   powers;
+	std::vector<float> coeffs;
+	for (const Term& _term : Terms) {
+		powers.push_back(power(_term.monomial, variable));
+		coeffs.push_back(_term.coefficient);
+	}
+
+	return Polynomial(powers.data(), coeffs.data(), powers.size());
+}
+
+MultiPolynomial MultiPolynomial::operator /(const MultiPolynomial& divisor) const {
+	int variable = common_variable(divisor);
+	return MultiPolynomial(univariate(variable) / divisor.univariate(variable), variable);
+}
+MultiPolynomial MultiPolynomial::operator %(const MultiPolynomial& divisor) const {
+	int variable = common_variable(divisor);
+	return MultiPolynomial(univariate(variable) % divisor.univariate(variable), variable);
+}
+
+bool MultiPolynomial::operator ==(const MultiPolynomial& polynomial) const {
+	if (Terms.size() != polynomial.Terms.size()) return false;
+
+	for (int i = 0; i < Terms.size(); i++) {
+		if (Terms[i].monomial != polynomial.Terms[i].monomial || Terms[i].coefficient != polynomial.Terms[i].coefficient) return false;
+	}
+
+	return true;
+}
+bool MultiPolynomial::operator !=(const MultiPolynomial& polynomial) const {
+	return !(*this == polynomial);
+}
+
+MultiPolynomial::operator bool() const {
+	return !Terms.empty();
+}
+
+std::ostream& operator <<(std::ostream& stream, const MultiPolynomial& polynomial) {
+	stream << '{';
+
+	float coeff; int pow;
+	for (int i = 0; i < polynomial.Terms.size(); i++) {
+		coeff = polynomial.Terms[i].coefficient;
+
+		stream << (coeff > 0 ? '+' : '-') << (coeff > 0 ? coeff : -coeff);
+
+		for (int variable = 0; variable < MultiPolynomial::MAX_VARIABLES; variable++) {
+			pow = MultiPolynomial::power(polynomial.Terms[i].monomial, variable);
+			if (pow == 0) continue;
+
+			stream << " x" << variable;
+			if (pow > 1) stream << '^' << pow;
+		}
+
+		if (i != polynomial.Terms.size() - 1) {
+			stream << ' ';
+		}
+	}
+
+	stream << '}';
+
+	return stream;
+}
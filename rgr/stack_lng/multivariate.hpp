@@ -0,0 +1,95 @@
+#pragma once
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "polynomial.hpp"
+
+/* класс "многочлен от нескольких переменных" x0, x1, ..., x7 с вещественными коэффициентами
+*
+*  показатели степеней одного одночлена упакованы в одно 64-битное слово :
+*  на переменную xi отводится байт, x0 --- старший байт ; показатель не больше MAX_POWER,
+*  а старший бит каждого байта остаётся нулевым и служит для обнаружения переполнения
+*
+*  поэтому сравнение одночленов в лексикографическом порядке (x0 > x1 > ... > x7) ---
+*  это сравнение целых чисел, а произведение одночленов --- сложение целых чисел
+*
+*  термы хранятся по убыванию одночленов, нулевых коэффициентов нет ;
+*  нулевой многочлен не содержит термов, его степень считается равной нулю */
+class MultiPolynomial {
+public:
+	using Monomial = std::uint64_t;
+
+	static const int MAX_VARIABLES = 8;
+	static const int MAX_POWER     = 127;
+
+	// упаковка показателей powers[0 .. count - 1] в одночлен ; при недопустимых показателях выбрасывается исключение 1
+	static Monomial monomial(const int* powers, int count);
+	// показатель переменной в одночлене
+	static int power(Monomial m, int variable);
+private:
+	struct Term {
+		Monomial monomial;
+		float    coefficient;
+	};
+
+	std::vector<Term> Terms;
+
+	static Monomial multiply_monomials(Monomial m1, Monomial m2);
+
+	// общая переменная двух многочленов от одной переменной (иначе исключение 1)
+	int common_variable(const MultiPolynomial& other) const;
+	// многочлен от одной переменной как Polynomial
+	Polynomial univariate(int variable) const;
+public:
+	MultiPolynomial();
+	MultiPolynomial(float coeff);
+	MultiPolynomial(Monomial m, float coeff);
+
+	// многочлен из массивов одночленов и коэффициентов (термы копируются как есть : по убыванию одночленов, без нулей)
+	MultiPolynomial(const Monomial* monomials, const float* coeffs, int count);
+
+	// многочлен от одной переменной xi с коэффициентами данного многочлена
+	MultiPolynomial(const Polynomial& polynomial, int variable = 0);
+
+	// переменная xi как многочлен
+	static MultiPolynomial variable(int index);
+
+	int count_terms() const;
+	// одночлен и коэффициент терма с данным номером (термы упорядочены по убыванию одночленов)
+	Monomial term_monomial(int index) const;
+	float    term_coefficient(int index) const;
+
+	// полная степень (наибольшая сумма показателей одночлена)
+	int deg() const;
+
+	/* многочлен от одной переменной : номер переменной (0, если многочлен постоянный)
+	*  или -1, если в многочлене встречаются разные переменные */
+	int single_variable() const;
+
+	// значение многочлена при значениях переменных values[0 .. MAX_VARIABLES - 1]
+	float operator ()(const float* values) const;
+
+	// коэффициент при данном одночлене
+	float operator [](Monomial m) const;
+
+	MultiPolynomial operator +(const MultiPolynomial& added) const;
+	MultiPolynomial operator -() const;
+	MultiPolynomial operator -(const MultiPolynomial& subbed) const;
+	MultiPolynomial operator *(const MultiPolynomial& multed) const;
+
+	/* деление определено только для многочленов от одной и той же переменной :
+	*  оно выполняется ядрами Polynomial ; иначе выбрасывается исключение 1 */
+	MultiPolynomial operator /(const MultiPolynomial& divisor) const;
+	MultiPolynomial operator %(const MultiPolynomial& divisor) const;
+
+	bool operator ==(const MultiPolynomial& polynomial) const;
+	bool operator !=(const MultiPolynomial& polynomial) const;
+
+	// преобразование в bool
+	operator bool() const;
+
+	/* вывод
+	*  формат вывода: {±a1 x0^2 x1 ±a2 x2 ±a3}, свободный член --- без переменных */
+	friend std::ostream& operator <<(std::ostream& stream, const MultiPolynomial& polynomial);
+};
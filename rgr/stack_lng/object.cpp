@@ -0,0 +1,270 @@
+#include <iostream>
+#include <climits>
+#include "polynomial.hpp"
+#include "multivariate.hpp"
+
+/* перечисление типов значений объектов в стековом языке : натуральное число, многочлен с вещественными коэффициентами
+*  и многочлен от нескольких переменных ; Uninitialized --- значение переменной, которой ещё ничего не присвоено */
+enum class ValueType { Integer, Polynomial, Multivariate, Uninitialized };
+
+/* деление и остаток чисел : исключение при делении на ноль и при переполнении (INT_MIN / -1),
+*  чтобы ошибка выполнения не завершала интерпретатор сигналом */
+inline int int_divide(int a, int b) {
+	if (b == 0 || (b == -1 && a == INT_MIN)) throw 1;
+	return a / b;
+}
+inline int int_modulo(int a, int b) {
+	if (b == 0 || (b == -1 && a == INT_MIN)) throw 1;
+	return a % b;
+}
+
+/* класс "объект" : значение с меткой типа
+*
+*  число хранится прямо в объекте, многочлены --- в общих блоках со счётчиком ссылок :
+*  копирование объекта только увеличивает счётчик, а значение в блоке никогда не изменяется
+*  (операции создают новые значения), поэтому несколько объектов могут безопасно делить один блок */
+class Object {
+private:
+	template<typename T>
+	struct Shared {
+		T   value;
+		int references;
+	};
+
+	ValueType type;
+	union {
+		int                      integer;
+		Shared<Polynomial>*      polynomial;
+		Shared<MultiPolynomial>* multivariate;
+	};
+
+	void retain() const {
+		switch (type) {
+		case ValueType::Polynomial:   polynomial->references++;   break;
+		case ValueType::Multivariate: multivariate->references++; break;
+		default:                      break;
+		}
+	}
+
+	// значение другого объекта без изменения счётчиков ; блок со счётчиком есть только у многочленов
+	void take_value(const Object& other) {
+		type = other.type;
+		if (type == ValueType::Polynomial || type == ValueType::Multivariate) polynomial = other.polynomial;
+		else                                                                  integer = other.integer;
+	}
+public:
+	/* конструкторы и декструкоры ; операторы присваивания */
+	Object(int n = 0) : type(ValueType::Integer), integer(n) {}
+	Object(Polynomial&& p) : type(ValueType::Polynomial), polynomial(new Shared<Polynomial>{ std::move(p), 1 }) {}
+	Object(const Polynomial& p) : Object(Polynomial(p)) {}
+	Object(MultiPolynomial&& p) : type(ValueType::Multivariate), multivariate(new Shared<MultiPolynomial>{ std::move(p), 1 }) {}
+
+	/* копия значения в собственном блоке : счётчик ссылок копии не общий с исходным объектом
+	*  (счётчики не атомарные, так значение передаётся другому потоку) */
+	Object clone() const {
+		switch (type) {
+		case ValueType::Polynomial:   return Object(Polynomial(polynomial->value));
+		case ValueType::Multivariate: return Object(MultiPolynomial(multivariate->value));
+		default: {
+			Object obj;
+			obj.take_value(*this);
+			return obj;
+		}
+		}
+	}
+
+	static Object uninitialized() {
+		Object obj;
+		obj.type = ValueType::Uninitialized;
+		return obj;
+	}
+
+	void clear() {
+		switch (type) {
+		case ValueType::Polynomial:   if (--polynomial->references == 0)   delete polynomial;   break;
+		case ValueType::Multivariate: if (--multivariate->references == 0) delete multivariate; break;
+		default:                      break;
+		}
+		type = ValueType::Integer;
+		integer = 0;
+	}
+	~Object() {
+		clear();
+	}
+	Object(const Object& other) {
+		take_value(other);
+		retain();
+	}
+	Object(Object&& other) noexcept {
+		take_value(other);
+
+		other.type = ValueType::Integer;
+		other.integer = 0;
+	}
+	Object& operator=(const Object& other) {
+		if (this == &other) return *this;
+
+		other.retain();
+		clear();
+
+		take_value(other);
+
+		return *this;
+	}
+	Object& operator=(Object&& other) noexcept {
+		if (this == &other) return *this;
+
+		clear();
+
+		take_value(other);
+
+		other.type = ValueType::Integer;
+		other.integer = 0;
+
+		return *this;
+	}
+
+	/* доступ к значению ; вызывающий отвечает за соответствие типа */
+	ValueType get_type() const {
+		return type;
+	}
+	int get_int() const {
+		return integer;
+	}
+	// новое значение объекта, который уже хранит число (тип не проверяется и не меняется)
+	void replace_int(int n) {
+		integer = n;
+	}
+	const Polynomial& get_polynomial() const {
+		return polynomial->value;
+	}
+	const MultiPolynomial& get_multivariate() const {
+		return multivariate->value;
+	}
+	// блок значения многочлена (объекты с одним блоком делят значение) ; у чисел --- nullptr
+	const void* block() const {
+		if (type == ValueType::Polynomial || type == ValueType::Multivariate) return polynomial;
+		return nullptr;
+	}
+
+	/* значение как многочлен от одной переменной (число --- многочлен нулевой степени) ;
+	*  для числа многочлен строится в buffer, иначе возвращается ссылка на хранимый многочлен */
+	const Polynomial& as_polynomial(Polynomial& buffer) const {
+		if (type == ValueType::Polynomial) return polynomial->value;
+
+		buffer = Polynomial((float)integer);
+		return buffer;
+	}
+
+	/* приведение значения к многочлену от нескольких переменных : число и многочлен считаются многочленами от x0 */
+	MultiPolynomial as_multivariate() const {
+		switch (type) {
+		case ValueType::Integer:      return MultiPolynomial((float)integer);
+		case ValueType::Polynomial:   return MultiPolynomial(polynomial->value);
+		case ValueType::Multivariate: return multivariate->value;
+		default:                      return MultiPolynomial();
+		}
+	}
+
+	// истинность значения (для ji)
+	bool truth() const {
+		switch (type) {
+		case ValueType::Integer:      return integer;
+		case ValueType::Polynomial:   return polynomial->value;
+		case ValueType::Multivariate: return multivariate->value;
+		default:                      return false;
+		}
+	}
+
+/* макрос с параметорм : значок операции +, -, *, /, %
+*  применяет операцию к двум объектам ; используется только в соостветсвующих операторах
+*  т. к. использует имена формальных параметров ;
+*  если один из операндов --- многочлен от нескольких переменных, то и второй приводится к нему */
+#define CALCULATE(infix_operator) \
+		if (type == ValueType::Integer && other.type == ValueType::Integer) {\
+			return Object(integer infix_operator other.integer);\
+		}\
+		if (type == ValueType::Multivariate || other.type == ValueType::Multivariate) {\
+			return Object(as_multivariate() infix_operator other.as_multivariate());\
+		}\
+		Polynomial buffer1, buffer2;\
+		return Object(as_polynomial(buffer1) infix_operator other.as_polynomial(buffer2));
+// end define
+
+	/* операторы арифметических дейсвий с объектами */
+	Object operator +(const Object& other) const {
+		CALCULATE(+)
+	}
+	Object operator -(const Object& other) const {
+		CALCULATE(-)
+	}
+	Object operator *(const Object& other) const {
+		CALCULATE(*)
+	}
+	Object operator /(const Object& other) const {
+		if (type == ValueType::Integer && other.type == ValueType::Integer) return Object(int_divide(integer, other.integer));
+		CALCULATE(/)
+	}
+	Object operator %(const Object& other) const {
+		if (type == ValueType::Integer && other.type == ValueType::Integer) return Object(int_modulo(integer, other.integer));
+		CALCULATE(%)
+	}
+
+/* аналогичный макрос для сравнений ==, != */
+#define COMPARE_1(infix_operator) \
+		if (type == ValueType::Integer && other.type == ValueType::Integer) {\
+			return integer infix_operator other.integer;\
+		}\
+		if (type == ValueType::Multivariate || other.type == ValueType::Multivariate) {\
+			return as_multivariate() infix_operator other.as_multivariate();\
+		}\
+		Polynomial buffer1, buffer2;\
+		return as_polynomial(buffer1) infix_operator other.as_polynomial(buffer2);
+// end define
+
+	/* операторы сравнений */
+	bool operator ==(const Object& other) const {
+		COMPARE_1(==)
+	}
+	bool operator !=(const Object& other) const {
+		COMPARE_1(!=)
+	}
+
+/* аналогичный макрос для операций <, <=, >, >= */
+#define COMPARE_2(infix_operator) \
+		if (type == ValueType::Integer && other.type == ValueType::Integer) {\
+			return integer infix_operator other.integer;\
+		}
+// end define
+
+	/* операторы сравнений <, <=, >, >= 
+	* выбрасывют исключение 1, если не удалось сравнить объекты,
+	* например, если один операнд - число, а другой - многчлен */
+	bool operator <(const Object& other) const {
+		COMPARE_2(<)
+		throw 1;
+	}
+	bool operator <=(const Object& other) const {
+		COMPARE_2(<=)
+		throw 1;
+	}
+	bool operator >(const Object& other) const {
+		COMPARE_2(>)
+		throw 1;
+	}
+	bool operator >=(const Object& other) const {
+		COMPARE_2(>=)
+		throw 1;
+	}
+
+	// вывод значения
+	friend std::ostream& operator <<(std::ostream& stream, const Object& obj) {
+		switch (obj.type) {
+		case ValueType::Integer:      stream << obj.integer;               break;
+		case ValueType::Polynomial:   stream << obj.polynomial->value;     break;
+		case ValueType::Multivariate: stream << obj.multivariate->value;   break;
+		default:                      break;
+		}
+		return stream;
+	}
+};
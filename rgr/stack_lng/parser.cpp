@@ -21,6 +21,9 @@ struct SymbolicToken {
 enum TokenClass { Push, Pop, Jmp, Ji, Read, Write, End,	// ключевые слова : push, pop, jmp, ji, read, write, end
 				  ArithmeticOp, CmpOp,					// арифметическая операция, операция сравнения
 				  Atpow, Deg, Derivative, Value,        // ключевые слова : atpow, deg, derivative, value
+				  MVar,									// ключевое слово : mvar (переменная многочлена от нескольких переменных)
+				  Roots,								// ключевое слово : roots (действительные корни многочлена)
+				  DerivN, Shift,						// ключевые слова : derivn (производная порядка n), shift (сдвиг аргумента)
 				  Comment, Error, EndOfFile 			// комментарий, ошибка, конец файла
 				};
 
@@ -65,6 +68,10 @@ std::ostream& operator <<(std::ostream& stream, Token token) {
 	case Deg:   	 stream << "deg";        break;
 	case Derivative: stream << "derivative"; break;
 	case Value:      stream << "value";      break;
+	case MVar:       stream << "mvar";       break;
+	case Roots:      stream << "roots";      break;
+	case DerivN:     stream << "derivn";     break;
+	case Shift:      stream << "shift";      break;
 
 	case ArithmeticOp: stream << (char)token.value; break;
 	case CmpOp: switch (token.value) {
@@ -131,6 +138,8 @@ private:
 	std::vector<ObjectName>   name_table;		// таблица имён
 
 	friend class Interpreter;
+	friend class Compiler;
+	friend class Profiler;
 public:
 	/* конструктор по умолчанию : необходим для создани пустого объекта;
 	*  анализатор возвращает пустую обработанную программу, если не удалось открыть файл */
@@ -230,6 +239,8 @@ enum State { s_A1, s_A2,				// поиск новой лексемы
 		    };
 const int STATES_COUNT = 24;    // количество состояний автомата (без s_Stop)
 
+const int DETECTION_TABLE_SIZE = 47;	// количество строк таблицы обнаружений
+
 /* класс "лексический анализатор" */
 class Parser {
 private:
@@ -521,6 +532,34 @@ private:
 
 		return s_C1;
 	}
+	State C1o() {
+		token_class = MVar;
+		token_value = 0;
+		add_token();
+
+		return s_C1;
+	}
+	State C1p() {
+		token_class = Roots;
+		token_value = 0;
+		add_token();
+
+		return s_C1;
+	}
+	State C1q() {
+		token_class = DerivN;
+		token_value = 0;
+		add_token();
+
+		return s_C1;
+	}
+	State C1r() {
+		token_class = Shift;
+		token_value = 0;
+		add_token();
+
+		return s_C1;
+	}
 	State C1m() {
 		add_polynomial();
 		token_value = name_table_index;
@@ -932,13 +971,15 @@ public:
 		detection_table.init_vector['d' - 'a'] = 21;
 		detection_table.init_vector['e' - 'a'] =  0;
 		detection_table.init_vector['j' - 'a'] =  2;
+		detection_table.init_vector['m' - 'a'] = 35;
 		detection_table.init_vector['p' - 'a'] =  5;
 		detection_table.init_vector['r' - 'a'] = 10;
+		detection_table.init_vector['s' - 'a'] = 43;
 		detection_table.init_vector['v' - 'a'] = 31;
 		detection_table.init_vector['w' - 'a'] = 13;
 
 		/* инициализация самой таблицы */
-		for (int i = 0; i < 35; ++i)
+		for (int i = 0; i < DETECTION_TABLE_SIZE; ++i)
 		{
 			detection_table.table[i].alt = -1;
 			detection_table.table[i].procedure = &Parser::B1b;
@@ -959,7 +1000,7 @@ public:
 		detection_table.table[8].letter =  's';											
 		detection_table.table[9].letter =  'h';											detection_table.table[9].procedure = &Parser::E1a;
 												// push
-		detection_table.table[10].letter = 'e';											
+		detection_table.table[10].letter = 'e';		detection_table.table[10].alt = 38;											
 		detection_table.table[11].letter = 'a';											
 		detection_table.table[12].letter = 'd';											detection_table.table[12].procedure = &Parser::C1c;
 												// read
@@ -979,7 +1020,7 @@ public:
 		detection_table.table[23].letter = 'r';											
 		detection_table.table[24].letter = 'i';											
 		detection_table.table[25].letter = 'v';											
-		detection_table.table[26].letter = 'a';											
+		detection_table.table[26].letter = 'a';		detection_table.table[26].alt = 42;											
 		detection_table.table[27].letter = 't';											
 		detection_table.table[28].letter = 'i';											
 		detection_table.table[29].letter = 'v';											
@@ -990,6 +1031,22 @@ public:
 		detection_table.table[33].letter = 'u';											
 		detection_table.table[34].letter = 'e'; 										detection_table.table[34].procedure = &Parser::C1l;
 												// value
+		detection_table.table[35].letter = 'v';											
+		detection_table.table[36].letter = 'a';											
+		detection_table.table[37].letter = 'r';											detection_table.table[37].procedure = &Parser::C1o;
+												// mvar
+		detection_table.table[38].letter = 'o';											
+		detection_table.table[39].letter = 'o';											
+		detection_table.table[40].letter = 't';											
+		detection_table.table[41].letter = 's';											detection_table.table[41].procedure = &Parser::C1p;
+												// roots
+		detection_table.table[42].letter = 'n';											detection_table.table[42].procedure = &Parser::C1q;
+												// derivn
+		detection_table.table[43].letter = 'h';											
+		detection_table.table[44].letter = 'i';											
+		detection_table.table[45].letter = 'f';											
+		detection_table.table[46].letter = 't';											detection_table.table[46].procedure = &Parser::C1r;
+												// shift
 	}
 
 	/* основная функция, обрабатывающая программу */
@@ -1055,7 +1112,7 @@ private:
 			char alt;					// альтернатива
 			parser_procedure procedure;	// процедура
 		};
-		DetectionTableLine table[35];		// таблица
+		DetectionTableLine table[DETECTION_TABLE_SIZE];		// таблица
 	};
 	DetectionTable 		 detection_table;									// таблциа обнаружений
 	int 		         detection_index;									// регистр обнаружений
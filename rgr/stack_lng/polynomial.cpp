@@ -1,9 +1,19 @@
 #include <iostream>
 #include <fstream>
+#include <vector>
 #include "polynomial.hpp"
+#include "polynomial_parallel.hpp"
+#include "polynomial_alloc.hpp"
+
+Polynomial::Term* Polynomial::allocate_terms(int _count_terms) {
+	return (Term*)TermAllocator::allocate(_count_terms * sizeof(Term));
+}
+void Polynomial::free_terms(Term* terms) {
+	TermAllocator::deallocate(terms);
+}
 
 void Polynomial::alloc(int _count_terms) {
-	Terms = new Term[_count_terms];
+	Terms = allocate_terms(_count_terms);
 	count_terms = _count_terms;
 }
 
@@ -19,6 +29,16 @@ Polynomial::Polynomial(int power, float coeff) {
 	Terms->coefficient = coeff;
 	Terms->power = power;
 }
+Polynomial::Polynomial(const int* powers, const float* coeffs, int _count_terms) : Terms(nullptr), count_terms(0) {
+	if (_count_terms == 0) return;
+
+	alloc(_count_terms);
+
+	for (int i = 0; i < count_terms; i++) {
+		Terms[i].coefficient = coeffs[i];
+		Terms[i].power = powers[i];
+	}
+}
 Polynomial::Polynomial(const Polynomial& other) {
 	alloc(other.count_terms);
 
@@ -40,7 +60,7 @@ Polynomial::~Polynomial() {
 
 void Polynomial::clear() {
 	if (Terms) {
-		delete[] Terms;
+		free_terms(Terms);
 		Terms = nullptr;
 	}
 	count_terms = 0;
@@ -124,7 +144,7 @@ Polynomial Polynomial::operator +(const Polynomial& added) const {
 	auto max = [](int a, int b) { return a > b ? a : b; };
 	int max_power = max(deg(), added.deg());
 
-	Term* sum_terms = new Term[max_power + 1];
+	Term* sum_terms = allocate_terms(max_power + 1);
 	int count_sum_terms = 0;
 
 	float pow_coeff;
@@ -139,7 +159,7 @@ Polynomial Polynomial::operator +(const Polynomial& added) const {
 	}
 
 	if (count_sum_terms == 0) {
-		delete[] sum_terms;
+		free_terms(sum_terms);
 	}
 	else {
 		sum.Terms = sum_terms;
@@ -175,7 +195,7 @@ Polynomial Polynomial::operator -(const Polynomial& subbed) const {
 	auto max = [](int a, int b) { return a > b ? a : b; };
 	int max_power = max(deg(), subbed.deg());
 
-	Term* dif_terms = new Term[max_power + 1];
+	Term* dif_terms = allocate_terms(max_power + 1);
 	int count_dif_terms = 0;
 
 	float pow_coeff;
@@ -190,7 +210,7 @@ Polynomial Polynomial::operator -(const Polynomial& subbed) const {
 	}
 
 	if (count_dif_terms == 0) {
-		delete[] dif_terms;
+		free_terms(dif_terms);
 	}
 	else {
 		dif.Terms = dif_terms;
@@ -206,9 +226,12 @@ Polynomial Polynomial::operator *(const Polynomial& multed) const {
 
 	if (count_terms == 0 || multed.count_terms == 0) return prod;
 
+	// большие множители умножаются параллельными ядрами
+	if (PolynomialParallel::worth(deg(), multed.deg())) return PolynomialParallel::multiply(*this, multed);
+
 	int max_power = deg() + multed.deg();
 
-	Term* temp_terms = new Term[max_power + 1];
+	Term* temp_terms = allocate_terms(max_power + 1);
 	int prod_terms = 0;
 
 	float pow_coeff;
@@ -233,9 +256,24 @@ Polynomial Polynomial::operator *(const Polynomial& multed) const {
 	return prod;
 };
 
+// старший терм остатка при делении должен сократиться ; если от округления остался терм степени power, он убирается
+static void drop_term(Polynomial& remainder, int power) {
+	float rest = remainder[power];
+	if (rest != 0) remainder = remainder - Polynomial(power, rest);
+}
+
 Polynomial Polynomial::operator /(const Polynomial& divisor) const {
+	// деление на нулевой многочлен (в том числе на число 0) не определено
+	if (divisor[divisor.deg()] == 0) throw 1;
+
 	if (deg() < divisor.deg()) return Polynomial();
 
+	if (divisor.count_terms != 0 && PolynomialParallel::worth(deg(), divisor.deg())) {
+		Polynomial quot;
+		PolynomialParallel::divide(*this, divisor, &quot, nullptr);
+		return quot;
+	}
+
 	Polynomial remainder(*this);
 
 	Polynomial quot;
@@ -248,13 +286,15 @@ Polynomial Polynomial::operator /(const Polynomial& divisor) const {
 
 	float devisor_deg_coeff = divisor[devisor_deg];
 
-	while (remainder_deg >= devisor_deg) {
+	// у нулевого остатка степень 0 : без проверки старшего коэффициента деление на многочлен степени 0 не заканчивается
+	while (remainder[remainder_deg] != 0 && remainder_deg >= devisor_deg) {
 		quot_term.Terms->power = remainder_deg - devisor_deg;
 		quot_term.Terms->coefficient = remainder[remainder_deg] / devisor_deg_coeff;
 
 		quot = quot + quot_term;
 
 		remainder = remainder - quot_term * divisor;
+		drop_term(remainder, remainder_deg);
 		remainder_deg = remainder.deg();
 	}
 
@@ -262,8 +302,15 @@ Polynomial Polynomial::operator /(const Polynomial& divisor) const {
 }
 
 Polynomial Polynomial::operator %(const Polynomial& divisor) const {
+	if (divisor[divisor.deg()] == 0) throw 1;
+
 	if (deg() < divisor.deg()) return Polynomial();
 
+	if (divisor.count_terms != 0 && PolynomialParallel::worth(deg(), divisor.deg())) {
+		Polynomial remainder;
+		PolynomialParallel::divide(*this, divisor, nullptr, &remainder);
+		return remainder;
+	}
 
 	Polynomial remainder(*this);
 
@@ -276,11 +323,13 @@ Polynomial Polynomial::operator %(const Polynomial& divisor) const {
 
 	float devisor_deg_coeff = divisor[devisor_deg];
 
-	while (remainder_deg >= devisor_deg) {
+	// у нулевого остатка степень 0 : без проверки старшего коэффициента деление на многочлен степени 0 не заканчивается
+	while (remainder[remainder_deg] != 0 && remainder_deg >= devisor_deg) {
 		quot_term.Terms->power = remainder_deg - devisor_deg;
 		quot_term.Terms->coefficient = remainder[remainder_deg] / devisor_deg_coeff;
 
 		remainder = remainder - quot_term * divisor;
+		drop_term(remainder, remainder_deg);
 
 		remainder_deg = remainder.deg();
 	}
@@ -309,7 +358,7 @@ bool Polynomial::operator !=(const Polynomial& polynomial) const {
 	return false;
 }
 
-Polynomial::operator bool() {
+Polynomial::operator bool() const {
 	return count_terms;
 }
 
@@ -347,6 +396,109 @@ Polynomial Polynomial::derivative() const {
 	return derived;
 }
 
+Polynomial Polynomial::derivative(int order) const {
+	if (order <= 0) return *this;
+
+	Polynomial derived;
+	derived.alloc(count_terms);
+	derived.count_terms = 0;
+
+	// множитель при дифференцировании x^power order раз : power (power - 1) ... (power - order + 1)
+	float factor;
+	for (Term _term : *this) {
+		if (_term.power < order) continue;
+
+		factor = _term.coefficient;
+		for (int i = 0; i < order; i++) {
+			factor *= _term.power - i;
+		}
+
+		derived.Terms[derived.count_terms].coefficient = factor;
+		derived.Terms[derived.count_terms].power = _term.power - order;
+		derived.count_terms++;
+	}
+
+	if (derived.count_terms == 0) derived.clear();
+
+	return derived;
+}
+
+static const int TAYLOR_SHIFT_BASE = 64;	// длина, ниже которой сдвиг выполняется схемой Горнера
+
+/* сдвиг плотного многочлена coeffs[0 .. len - 1] на месте ;
+*  binomials[j] --- коэффициенты (x + a)^(2^j) */
+static void taylor_shift_dense(float* coeffs, int len, float a, const std::vector<std::vector<float>>& binomials) {
+	if (len <= TAYLOR_SHIFT_BASE) {
+		// последовательное деление на (x - a) по схеме Горнера : O(len^2)
+		for (int i = 0; i < len - 1; i++) {
+			for (int j = len - 2; j >= i; j--) {
+				coeffs[j] += a * coeffs[j + 1];
+			}
+		}
+		return;
+	}
+
+	/* P = P_low + x^h P_high, h --- степень двойки ; P(x + a) = P_low(x + a) + (x + a)^h P_high(x + a),
+	*  где последнее произведение считается быстрым умножением */
+	int j = 0;
+	while ((2 << j) < len) j++;
+	int h = 1 << j;
+
+	taylor_shift_dense(coeffs,     h,       a, binomials);
+	taylor_shift_dense(coeffs + h, len - h, a, binomials);
+
+	std::vector<float> prod(len);
+	PolynomialParallel::multiply_dense(binomials[j].data(), h + 1, coeffs + h, len - h, prod.data());
+
+	for (int i = 0; i < len; i++) {
+		coeffs[i] = (i < h ? coeffs[i] : 0) + prod[i];
+	}
+}
+
+Polynomial Polynomial::taylor_shift(float a) const {
+	if (count_terms == 0) return Polynomial();
+
+	// плотные коэффициенты ; при повторе степени учитывается первый терм, как в operator[]
+	int len = deg() + 1;
+	std::vector<float> coeffs(len, 0.0f);
+	for (int i = count_terms - 1; i >= 0; i--) {
+		coeffs[Terms[i].power] = Terms[i].coefficient;
+	}
+
+	if (a != 0) {
+		std::vector<std::vector<float>> binomials(1, std::vector<float>{ a, 1 });
+		while ((1 << binomials.size()) < len) {
+			const std::vector<float>& last = binomials.back();
+
+			std::vector<float> square(2 * last.size() - 1);
+			PolynomialParallel::multiply_dense(last.data(), last.size(), last.data(), last.size(), square.data());
+			binomials.push_back(std::move(square));
+		}
+
+		taylor_shift_dense(coeffs.data(), len, a, binomials);
+	}
+
+	int shifted_count = 0;
+	for (int pow = 0; pow < len; pow++) {
+		if (coeffs[pow] != 0) shifted_count++;
+	}
+
+	Polynomial shifted;
+	if (shifted_count == 0) return shifted;
+
+	shifted.alloc(shifted_count);
+	int i = 0;
+	for (int pow = 0; pow < len; pow++) {
+		if (coeffs[pow] == 0) continue;
+
+		shifted.Terms[i].coefficient = coeffs[pow];
+		shifted.Terms[i].power = pow;
+		i++;
+	}
+
+	return shifted;
+}
+
 std::istream& skipspaces(std::istream& stream) {
 	while (stream.peek() == ' ' || stream.peek() == '\n') stream.ignore();
 
@@ -391,7 +543,7 @@ std::istream& operator >>(std::istream& stream, Polynomial& polynomial) {
 
 		polynomial.count_terms = 0;
 		int size = 1;
-		polynomial.Terms = new Polynomial::Term[1];
+		polynomial.Terms = Polynomial::allocate_terms(1);
 
 		char sign; int _power; float _coefficient;
 		while (true) {
@@ -421,13 +573,13 @@ std::istream& operator >>(std::istream& stream, Polynomial& polynomial) {
 
 			if (polynomial.count_terms >= size) {
 				size *= 2;
-				Polynomial::Term* twice_terms = new Polynomial::Term[size];
+				Polynomial::Term* twice_terms = Polynomial::allocate_terms(size);
 
 				for (int i = 0; i < polynomial.count_terms; i++) {
 					twice_terms[i] = polynomial.Terms[i];
 				}
 
-				delete[] polynomial.Terms;
+				Polynomial::free_terms(polynomial.Terms);
 				polynomial.Terms = twice_terms;
 			}
 
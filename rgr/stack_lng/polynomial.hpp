@@ -14,6 +14,10 @@ private:
 	int count_terms;
 
 	void alloc(int _count_terms);
+
+	// память под массивы термов выделяется через TermAllocator (списки свободных блоков, арены)
+	static Term* allocate_terms(int _count_terms);
+	static void  free_terms(Term* terms);
 public:
 
 	/* многочлен P(x) = 0 в программе задаётся объектом со значениями поля count_terms = 0 ;
@@ -22,6 +26,8 @@ public:
 	Polynomial();
 	Polynomial(float coeff);
 	Polynomial(int power, float coeff);
+	// многочлен из массивов степеней и коэффициентов (термы копируются как есть)
+	Polynomial(const int* powers, const float* coeffs, int _count_terms);
 	Polynomial(const Polynomial& other);
 	Polynomial(Polynomial&& other) noexcept;
 	~Polynomial();
@@ -69,7 +75,7 @@ public:
 	bool operator !=(const Polynomial& polynomial) const;
 
 	// преобразование в bool
-	operator bool();
+	operator bool() const;
 
 	// степень многочлена
 	int deg() const;
@@ -77,6 +83,12 @@ public:
 	// производная
 	Polynomial derivative() const;
 
+	// производная порядка order (за один проход по термам) ; при order <= 0 возвращается копия
+	Polynomial derivative(int order) const;
+
+	// сдвиг аргумента : многочлен P(x + a)
+	Polynomial taylor_shift(float a) const;
+
 	/* ввод - вывод
 	* формат ввода-вывода: [±0 : a0 ±1 : a1 ±2 : a2 ...] */
 
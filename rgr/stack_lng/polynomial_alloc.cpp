@@ -0,0 +1,289 @@
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+#include "polynomial_alloc.hpp"
+
+static const int         COUNT_CLASSES      = 7;		// классы размеров 16, 32, ..., 1024 байт
+static const std::size_t MIN_CLASS_BYTES    = 16;
+static const int         MAX_FREE_PER_CLASS = 4096;		// больше свободных блоков одного класса не храним
+
+static const int ORIGIN_SYSTEM = -1;	// блок получен у системы напрямую
+static const int ORIGIN_ARENA  = -2;	// блок взят из арены
+
+/* заголовок перед каждым выделенным блоком */
+struct BlockHeader {
+	int origin;		// номер класса размера или ORIGIN_SYSTEM / ORIGIN_ARENA
+	int reserved;	// выравнивание данных по 8 байт
+};
+
+/* списки свободных блоков текущего потока ; блоки связаны через первое слово данных */
+struct FreeLists {
+	BlockHeader* heads[COUNT_CLASSES];
+	int          lengths[COUNT_CLASSES];
+
+	FreeLists();
+	~FreeLists();
+};
+
+/* счётчики статистики потока : изменяет их только свой поток (чтение и запись без атомарного сложения,
+*  так же быстро, как обычные счётчики), а stats читает их из любого потока */
+struct ThreadCounters {
+	std::atomic<long long> allocations;
+	std::atomic<long long> deallocations;
+	std::atomic<long long> pool_hits;
+	std::atomic<long long> arena_allocations;
+	std::atomic<long long> system_allocations;
+	std::atomic<long long> system_bytes;
+	bool                   registered;		// счётчики потока добавлены в список потоков
+
+	void add_to(AllocationStats& sum) const;
+};
+
+// при завершении потока его счётчики переносятся в общую сумму завершившихся потоков
+struct CountersRegistration {
+	~CountersRegistration();
+};
+
+static thread_local FreeLists            free_lists;
+static thread_local bool                 free_lists_alive = false;		// списки ещё не разрушены при завершении потока
+static thread_local ThreadCounters       counters;
+static thread_local CountersRegistration counters_registration;
+static thread_local PolynomialArena*     current_arena = nullptr;
+
+/* счётчики всех потоков ; функции, а не глобальные объекты, чтобы они были созданы раньше первого потока */
+static std::mutex& counters_mutex() {
+	static std::mutex mutex;
+	return mutex;
+}
+static std::vector<ThreadCounters*>& live_counters() {
+	static std::vector<ThreadCounters*> list;
+	return list;
+}
+static AllocationStats retired_counters = {};	// сумма счётчиков завершившихся потоков
+static AllocationStats reset_counters   = {};	// сумма всех счётчиков при последнем reset_stats
+
+static void add(std::atomic<long long>& counter, long long value) {
+	counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+static ThreadCounters& thread_counters() {
+	if (!counters.registered) {
+		std::lock_guard<std::mutex> lock(counters_mutex());
+		live_counters().push_back(&counters);
+		counters.registered = true;
+		(void)&counters_registration;		// регистрирует деструктор для этого потока
+	}
+	return counters;
+}
+
+void ThreadCounters::add_to(AllocationStats& sum) const {
+	sum.allocations        += allocations.load(std::memory_order_relaxed);
+	sum.deallocations      += deallocations.load(std::memory_order_relaxed);
+	sum.pool_hits          += pool_hits.load(std::memory_order_relaxed);
+	sum.arena_allocations  += arena_allocations.load(std::memory_order_relaxed);
+	sum.system_allocations += system_allocations.load(std::memory_order_relaxed);
+	sum.system_bytes       += system_bytes.load(std::memory_order_relaxed);
+}
+
+CountersRegistration::~CountersRegistration() {
+	std::lock_guard<std::mutex> lock(counters_mutex());
+	std::vector<ThreadCounters*>& list = live_counters();
+	for (std::size_t i = 0; i < list.size(); i++) {
+		if (list[i] != &counters) continue;
+
+		counters.add_to(retired_counters);
+		list.erase(list.begin() + i);
+		break;
+	}
+}
+
+// сумма счётчиков всех потоков ; вызывается под counters_mutex
+static AllocationStats total_counters() {
+	AllocationStats sum = retired_counters;
+	for (const ThreadCounters* thread : live_counters()) thread->add_to(sum);
+	return sum;
+}
+
+static BlockHeader*& next_free(BlockHeader* header) {
+	return *(BlockHeader**)(header + 1);
+}
+
+FreeLists::FreeLists() {
+	for (int i = 0; i < COUNT_CLASSES; i++) {
+		heads[i] = nullptr;
+		lengths[i] = 0;
+	}
+	free_lists_alive = true;
+}
+FreeLists::~FreeLists() {
+	free_lists_alive = false;
+
+	for (int i = 0; i < COUNT_CLASSES; i++) {
+		while (heads[i]) {
+			BlockHeader* header = heads[i];
+			heads[i] = next_free(header);
+			::operator delete(header);
+		}
+	}
+}
+
+static int size_class(std::size_t bytes) {
+	int index = 0;
+	std::size_t class_bytes = MIN_CLASS_BYTES;
+	while (class_bytes < bytes) {
+		class_bytes *= 2;
+		index++;
+	}
+	return index;
+}
+
+static BlockHeader* system_block(std::size_t bytes) {
+	ThreadCounters& thread = thread_counters();
+	add(thread.system_allocations, 1);
+	add(thread.system_bytes, sizeof(BlockHeader) + bytes);
+	return (BlockHeader*)::operator new(sizeof(BlockHeader) + bytes);
+}
+
+void* TermAllocator::allocate(std::size_t bytes) {
+	ThreadCounters& thread = thread_counters();
+	add(thread.allocations, 1);
+
+	BlockHeader* header;
+	if (current_arena && (header = (BlockHeader*)current_arena->allocate(sizeof(BlockHeader) + bytes))) {
+		add(thread.arena_allocations, 1);
+		header->origin = ORIGIN_ARENA;
+		return header + 1;
+	}
+
+	if (bytes > MAX_POOLED_BYTES) {
+		header = system_block(bytes);
+		header->origin = ORIGIN_SYSTEM;
+		return header + 1;
+	}
+
+	int index = size_class(bytes);
+	FreeLists& lists = free_lists;
+	if (lists.heads[index]) {
+		add(thread.pool_hits, 1);
+		header = lists.heads[index];
+		lists.heads[index] = next_free(header);
+		lists.lengths[index]--;
+	}
+	else {
+		header = system_block(MIN_CLASS_BYTES << index);
+	}
+
+	header->origin = index;
+	return header + 1;
+}
+
+void TermAllocator::deallocate(void* ptr) {
+	if (!ptr) return;
+
+	add(thread_counters().deallocations, 1);
+
+	BlockHeader* header = (BlockHeader*)ptr - 1;
+	switch (header->origin) {
+	case ORIGIN_ARENA:  return;
+	case ORIGIN_SYSTEM: ::operator delete(header); return;
+	}
+
+	// после разрушения списков потока (глобальные объекты) блоки возвращаются системе
+	if (!free_lists_alive || free_lists.lengths[header->origin] >= MAX_FREE_PER_CLASS) {
+		::operator delete(header);
+		return;
+	}
+
+	FreeLists& lists = free_lists;
+	next_free(header) = lists.heads[header->origin];
+	lists.heads[header->origin] = header;
+	lists.lengths[header->origin]++;
+}
+
+AllocationStats TermAllocator::stats() {
+	std::lock_guard<std::mutex> lock(counters_mutex());
+	AllocationStats sum = total_counters();
+
+	sum.allocations        -= reset_counters.allocations;
+	sum.deallocations      -= reset_counters.deallocations;
+	sum.pool_hits          -= reset_counters.pool_hits;
+	sum.arena_allocations  -= reset_counters.arena_allocations;
+	sum.system_allocations -= reset_counters.system_allocations;
+	sum.system_bytes       -= reset_counters.system_bytes;
+	return sum;
+}
+void TermAllocator::reset_stats() {
+	std::lock_guard<std::mutex> lock(counters_mutex());
+	reset_counters = total_counters();
+}
+
+// ---------------------------------------
+// арена
+// ---------------------------------------
+
+PolynomialArena::PolynomialArena(std::size_t _block_bytes, std::size_t _max_bytes)
+	: block_bytes(_block_bytes), current_block(0), offset(0), oversized_bytes(0), max_bytes(_max_bytes) {}
+
+PolynomialArena::~PolynomialArena() {
+	for (char* block : blocks) {
+		::operator delete(block);
+	}
+	for (char* block : oversized) {
+		::operator delete(block);
+	}
+}
+
+void* PolynomialArena::allocate(std::size_t bytes) {
+	bytes = (bytes + 7) & ~(std::size_t)7;
+
+	ThreadCounters& thread = thread_counters();
+	if (bytes > block_bytes) {
+		if (max_bytes && used() + oversized_bytes + bytes > max_bytes) return nullptr;
+
+		add(thread.system_allocations, 1);
+		add(thread.system_bytes, bytes);
+		oversized.push_back((char*)::operator new(bytes));
+		oversized_bytes += bytes;
+		return oversized.back();
+	}
+
+	if (blocks.empty() || offset + bytes > block_bytes) {
+		std::size_t count_blocks = blocks.empty() ? 1 : current_block + 2;
+		if (max_bytes && count_blocks * block_bytes + oversized_bytes > max_bytes) return nullptr;
+
+		if (!blocks.empty()) current_block++;
+		if (current_block == blocks.size()) {
+			add(thread.system_allocations, 1);
+			add(thread.system_bytes, block_bytes);
+			blocks.push_back((char*)::operator new(block_bytes));
+		}
+		offset = 0;
+	}
+
+	void* ptr = blocks[current_block] + offset;
+	offset += bytes;
+	return ptr;
+}
+
+void PolynomialArena::reset() {
+	current_block = 0;
+	offset = 0;
+
+	for (char* block : oversized) {
+		::operator delete(block);
+	}
+	oversized.clear();
+	oversized_bytes = 0;
+}
+
+std::size_t PolynomialArena::used() const {
+	return current_block * block_bytes + offset;
+}
+
+PolynomialArena::Scope::Scope(PolynomialArena& arena) : previous(current_arena) {
+	current_arena = &arena;
+}
+PolynomialArena::Scope::~Scope() {
+	current_arena = previous;
+}
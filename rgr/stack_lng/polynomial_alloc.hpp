@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/* статистика выделения памяти под массивы термов ;
+*  счётчики ведутся для каждого потока отдельно, TermAllocator::stats складывает счётчики всех потоков */
+struct AllocationStats {
+	long long allocations;			// всего запросов на выделение
+	long long deallocations;		// всего освобождений
+	long long pool_hits;			// запросов, обслуженных списками свободных блоков
+	long long arena_allocations;	// запросов, обслуженных ареной
+	long long system_allocations;	// обращений к системному распределителю (operator new)
+	long long system_bytes;			// байт, запрошенных у системного распределителя
+};
+
+/* класс "распределитель термов"
+*
+*  небольшие массивы (до MAX_POOLED_BYTES байт) раскладываются по классам размеров 16, 32, ..., 1024 байт ;
+*  освобождённый блок кладётся в список свободных блоков своего класса и выдаётся повторно без malloc ;
+*  большие массивы запрашиваются у системы напрямую
+*
+*  если в текущем потоке действует область арены (PolynomialArena::Scope), память берётся из арены,
+*  а освобождение такого блока ничего не делает : арена освобождается целиком ;
+*  когда арена заполнена до предела, память снова берётся из списков свободных блоков
+*
+*  перед каждым блоком хранится заголовок с его происхождением, поэтому блок можно освободить
+*  в любом потоке и вне области арены */
+class TermAllocator {
+public:
+	static const std::size_t MAX_POOLED_BYTES = 1024;
+
+	static void* allocate(std::size_t bytes);
+	static void  deallocate(void* ptr);
+
+	// сумма счётчиков всех потоков (и завершившихся) после последнего reset_stats
+	static AllocationStats stats();
+	static void            reset_stats();
+};
+
+/* класс "арена" : память выделяется последовательно из больших блоков и освобождается
+*  только целиком, вызовом reset за O(1) (блоки остаются у арены для повторного использования) ;
+*  max_bytes --- предел памяти арены (0 --- без предела) : освобождение внутри арены ничего не делает,
+*  поэтому долгие вычисления в одной области без предела занимали бы всё больше памяти
+*
+*  к моменту reset или разрушения арены не должно остаться многочленов, память которых взята из неё */
+class PolynomialArena {
+private:
+	std::vector<char*> blocks;			// блоки арены
+	std::size_t        block_bytes;		// размер обычного блока
+	std::size_t        current_block;	// номер текущего блока
+	std::size_t        offset;			// занято байт в текущем блоке
+	std::vector<char*> oversized;		// блоки под запросы больше block_bytes (освобождаются при reset)
+	std::size_t        oversized_bytes;
+	std::size_t        max_bytes;		// предел памяти арены (0 --- без предела)
+
+	// nullptr, если запрос превысил бы предел
+	void* allocate(std::size_t bytes);
+
+	friend class TermAllocator;
+public:
+	explicit PolynomialArena(std::size_t _block_bytes = 1 << 20, std::size_t _max_bytes = 0);
+	~PolynomialArena();
+
+	PolynomialArena(const PolynomialArena&) = delete;
+	PolynomialArena& operator =(const PolynomialArena&) = delete;
+
+	void reset();
+
+	// занято байт (без учёта больших блоков)
+	std::size_t used() const;
+
+	/* область арены : пока объект существует, массивы термов в этом потоке берутся из арены */
+	class Scope {
+	private:
+		PolynomialArena* previous;
+	public:
+		explicit Scope(PolynomialArena& arena);
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator =(const Scope&) = delete;
+	};
+};
@@ -0,0 +1,190 @@
+#include <vector>
+#include <algorithm>
+#include "polynomial_batch.hpp"
+
+PolynomialBatch::PolynomialBatch() : offsets(1, 0) {}
+
+void PolynomialBatch::reserve(int count_polynomials, int count_terms) {
+	offsets.reserve(count_polynomials + 1);
+	powers.reserve(count_terms);
+	coefficients.reserve(count_terms);
+}
+void PolynomialBatch::clear() {
+	offsets.assign(1, 0);
+	powers.clear();
+	coefficients.clear();
+}
+
+void PolynomialBatch::push_term(int power, float coefficient) {
+	powers.push_back(power);
+	coefficients.push_back(coefficient);
+}
+void PolynomialBatch::close_polynomial() {
+	offsets.push_back(powers.size());
+}
+
+void PolynomialBatch::push_back(const Polynomial& polynomial) {
+	/* термы многочлена могут быть не упорядочены (например, после ввода) ;
+	*  при повторе степени учитывается первый терм, как в Polynomial::operator[] */
+	struct PowerCoeff { int power; float coefficient; };
+	std::vector<PowerCoeff> sorted;
+	for (auto& _term : polynomial) {
+		sorted.push_back({ _term.power, _term.coefficient });
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), [](const PowerCoeff& a, const PowerCoeff& b) { return a.power < b.power; });
+
+	for (int i = 0; i < sorted.size(); i++) {
+		if (i > 0 && sorted[i].power == sorted[i - 1].power) continue;
+		if (sorted[i].coefficient == 0) continue;
+
+		push_term(sorted[i].power, sorted[i].coefficient);
+	}
+	close_polynomial();
+}
+void PolynomialBatch::push_back(const PolynomialView& view) {
+	powers.insert(powers.end(), view.powers_data(), view.powers_data() + view.size());
+	coefficients.insert(coefficients.end(), view.coefficients_data(), view.coefficients_data() + view.size());
+	close_polynomial();
+}
+
+int PolynomialBatch::size() const {
+	return offsets.size() - 1;
+}
+int PolynomialBatch::count_terms() const {
+	return powers.size();
+}
+
+PolynomialView PolynomialBatch::operator [](int index) const {
+	int first = offsets[index];
+	return PolynomialView(powers.data() + first, coefficients.data() + first, offsets[index + 1] - first);
+}
+
+PolynomialBatch PolynomialBatch::operator +(const PolynomialBatch& added) const {
+	if (size() != added.size()) throw 1;
+
+	PolynomialBatch sum;
+	sum.reserve(size(), count_terms() + added.count_terms());
+
+	// слияние упорядоченных списков термов каждой пары многочленов
+	int i, j, i_end, j_end;
+	float pow_coeff;
+	for (int index = 0; index < size(); index++) {
+		i = offsets[index];       i_end = offsets[index + 1];
+		j = added.offsets[index]; j_end = added.offsets[index + 1];
+
+		while (i < i_end && j < j_end) {
+			if (powers[i] < added.powers[j]) {
+				sum.push_term(powers[i], coefficients[i]);
+				i++;
+			}
+			else if (powers[i] > added.powers[j]) {
+				sum.push_term(added.powers[j], added.coefficients[j]);
+				j++;
+			}
+			else {
+				pow_coeff = coefficients[i] + added.coefficients[j];
+				if (pow_coeff != 0) sum.push_term(powers[i], pow_coeff);
+				i++; j++;
+			}
+		}
+		for (; i < i_end; i++) sum.push_term(powers[i], coefficients[i]);
+		for (; j < j_end; j++) sum.push_term(added.powers[j], added.coefficients[j]);
+
+		sum.close_polynomial();
+	}
+
+	return sum;
+}
+
+PolynomialBatch PolynomialBatch::operator *(float scalar) const {
+	PolynomialBatch prod(*this);
+	prod *= scalar;
+	return prod;
+}
+PolynomialBatch& PolynomialBatch::operator *=(float scalar) {
+	// умножение на ноль даёт нулевые многочлены : термов не остаётся
+	if (scalar == 0) {
+		offsets.assign(offsets.size(), 0);
+		powers.clear();
+		coefficients.clear();
+		return *this;
+	}
+
+	float* coeffs = coefficients.data();
+	int n = coefficients.size();
+	for (int k = 0; k < n; k++) {
+		coeffs[k] *= scalar;
+	}
+
+	return *this;
+}
+
+PolynomialBatch PolynomialBatch::derivative() const {
+	PolynomialBatch derived;
+	derived.offsets.resize(offsets.size());
+	derived.powers.resize(powers.size());
+	derived.coefficients.resize(coefficients.size());
+
+	/* термы упорядочены, поэтому свободный член может быть только первым термом многочлена ;
+	*  остальные термы каждого многочлена обрабатываются одним непрерывным циклом */
+	int first, last, count = 0;
+	derived.offsets[0] = 0;
+	for (int index = 0; index < size(); index++) {
+		first = offsets[index];
+		last  = offsets[index + 1];
+		if (first < last && powers[first] == 0) first++;
+
+		const int*   src_powers = powers.data() + first;
+		const float* src_coeffs = coefficients.data() + first;
+		int*   dst_powers = derived.powers.data() + count;
+		float* dst_coeffs = derived.coefficients.data() + count;
+		for (int k = 0; k < last - first; k++) {
+			dst_coeffs[k] = src_coeffs[k] * src_powers[k];
+			dst_powers[k] = src_powers[k] - 1;
+		}
+
+		count += last - first;
+		derived.offsets[index + 1] = count;
+	}
+
+	derived.powers.resize(count);
+	derived.coefficients.resize(count);
+
+	return derived;
+}
+
+void PolynomialBatch::evaluate(float x, float* values) const {
+	int n = powers.size();
+	const int* pows = powers.data();
+
+	int max_power = 0;
+	for (int k = 0; k < n; k++) {
+		max_power = std::max(max_power, pows[k]);
+	}
+
+	/* x^power для всех термов сразу : возведение в степень по битам степени ;
+	*  количество шагов одно для всех термов, поэтому цикл по термам векторизуется */
+	std::vector<float> term_values(coefficients);
+	float* tv = term_values.data();
+	float base = x;
+	for (int bit = 0; (max_power >> bit) != 0; bit++) {
+		for (int k = 0; k < n; k++) {
+			tv[k] *= ((pows[k] >> bit) & 1) ? base : 1.0f;
+		}
+		base *= base;
+	}
+
+	float eval;
+	for (int index = 0; index < size(); index++) {
+		eval = 0;
+		for (int k = offsets[index]; k < offsets[index + 1]; k++) {
+			eval += tv[k];
+		}
+		values[index] = eval;
+	}
+}
+std::vector<float> PolynomialBatch::evaluate(float x) const {
+	std::vector<float> values(size());
+	evaluate(x, values.data());
+	return values;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <vector>
+#include "polynomial.hpp"
+#include "polynomial_view.hpp"
+
+/* класс "пакет многочленов" : много многочленов в общих непрерывных массивах (структура массивов)
+*
+*  термы i-го многочлена занимают позиции offsets[i] ... offsets[i + 1] - 1 массивов powers и coefficients ;
+*  внутри многочлена термы упорядочены по возрастанию степеней и не содержат нулевых коэффициентов
+*
+*  пакетные операции проходят по общим массивам одним циклом, который компилятор может векторизовать */
+class PolynomialBatch {
+private:
+	std::vector<int>   offsets;			// начало термов каждого многочлена (размер : количество многочленов + 1)
+	std::vector<int>   powers;			// степени термов всех многочленов
+	std::vector<float> coefficients;	// коэффициенты термов всех многочленов
+
+	// добавить в конец терм последнего многочлена / закончить последний многочлен
+	void push_term(int power, float coefficient);
+	void close_polynomial();
+public:
+	PolynomialBatch();
+
+	void reserve(int count_polynomials, int count_terms);
+	void clear();
+
+	// добавление многочлена в конец пакета (термы копируются и упорядочиваются)
+	void push_back(const Polynomial& polynomial);
+	void push_back(const PolynomialView& view);
+
+	// количество многочленов и общее количество термов
+	int size() const;
+	int count_terms() const;
+
+	// представление i-го многочлена без копирования
+	PolynomialView operator [](int index) const;
+
+	/* пакетные операции : применяются ко всем многочленам пакета
+	*  сложение пакетов одинакового размера (поэлементно) ; при разных размерах выбрасывается исключение 1 */
+	PolynomialBatch operator +(const PolynomialBatch& added) const;
+
+	// умножение всех многочленов на число
+	PolynomialBatch  operator *(float scalar) const;
+	PolynomialBatch& operator *=(float scalar);
+
+	// производные всех многочленов
+	PolynomialBatch derivative() const;
+
+	// значения всех многочленов при заданном x ; values должен вмещать size() чисел
+	void evaluate(float x, float* values) const;
+	std::vector<float> evaluate(float x) const;
+};
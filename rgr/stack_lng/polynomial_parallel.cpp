@@ -0,0 +1,279 @@
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "polynomial_parallel.hpp"
+
+static const int KARATSUBA_BASE  = 32;		// длина, ниже которой умножение выполняется "в столбик"
+static const int PARALLEL_LENGTH = 2048;	// длина, ниже которой подзадачи не отдаются другим потокам
+static const int MULT_CHUNK      = 4096;	// длина блока длинного множителя при коротком втором множителе
+static const int DIVISION_BLOCK  = 128;		// длина блока частного
+
+static int count_threads_setting = 0;		// 0 : по количеству ядер
+static int threshold_degree      = 256;
+
+static std::unique_ptr<ThreadPool> global_pool;
+static std::mutex                  global_pool_mutex;
+
+void PolynomialParallel::set_threads(int count_threads) {
+	std::lock_guard<std::mutex> lock(global_pool_mutex);
+
+	count_threads_setting = count_threads;
+	global_pool.reset();
+}
+int PolynomialParallel::threads() {
+	if (count_threads_setting > 0) return count_threads_setting;
+
+	int hardware = std::thread::hardware_concurrency();
+	return hardware > 0 ? hardware : 1;
+}
+
+void PolynomialParallel::set_threshold(int degree) {
+	threshold_degree = degree;
+}
+int PolynomialParallel::threshold() {
+	return threshold_degree;
+}
+
+bool PolynomialParallel::worth(int deg1, int deg2) {
+	return std::max(deg1, deg2) >= threshold_degree;
+}
+
+ThreadPool& PolynomialParallel::pool() {
+	std::lock_guard<std::mutex> lock(global_pool_mutex);
+
+	if (!global_pool) global_pool = std::make_unique<ThreadPool>(threads());
+	return *global_pool;
+}
+
+// ---------------------------------------
+// плотное представление
+// ---------------------------------------
+
+/* коэффициенты при степенях 0 ... deg ; при повторе степени учитывается первый терм, как в operator[] */
+static std::vector<float> to_dense(const Polynomial& polynomial) {
+	std::vector<float> dense(polynomial.deg() + 1, 0.0f);
+	std::vector<char>  seen(dense.size(), 0);
+
+	for (auto& _term : polynomial) {
+		if (seen[_term.power]) continue;
+
+		dense[_term.power] = _term.coefficient;
+		seen[_term.power] = 1;
+	}
+
+	return dense;
+}
+
+static Polynomial from_dense(const float* coeffs, int count) {
+	std::vector<int>   powers;
+	std::vector<float> nonzero;
+
+	for (int pow = 0; pow < count; pow++) {
+		if (coeffs[pow] == 0) continue;
+
+		powers.push_back(pow);
+		nonzero.push_back(coeffs[pow]);
+	}
+
+	return Polynomial(powers.data(), nonzero.data(), powers.size());
+}
+
+// ---------------------------------------
+// умножение
+// ---------------------------------------
+
+static void schoolbook(const float* a, int n1, const float* b, int n2, float* prod) {
+	std::fill(prod, prod + n1 + n2 - 1, 0.0f);
+
+	for (int i = 0; i < n1; i++) {
+		float  a_i = a[i];
+		float* row = prod + i;
+		for (int j = 0; j < n2; j++) {
+			row[j] += a_i * b[j];
+		}
+	}
+}
+
+/* произведение многочленов одинаковой длины n : prod[0 .. 2n - 2] */
+static void karatsuba(const float* a, const float* b, int n, float* prod) {
+	if (n <= KARATSUBA_BASE) {
+		schoolbook(a, n, b, n, prod);
+		return;
+	}
+
+	// a = a0 + x^h a1, b = b0 + x^h b1 ; длина младших частей h, старших h2 (h2 - h <= 1)
+	int h = n / 2, h2 = n - h;
+
+	std::vector<float> sums(2 * h2);
+	float* a_sum = sums.data();
+	float* b_sum = sums.data() + h2;
+	for (int i = 0; i < h; i++) {
+		a_sum[i] = a[i] + a[h + i];
+		b_sum[i] = b[i] + b[h + i];
+	}
+	if (h2 > h) {
+		a_sum[h] = a[2 * h];
+		b_sum[h] = b[2 * h];
+	}
+
+	std::vector<float> middle(2 * h2 - 1);
+
+	prod[2 * h - 1] = 0;
+	if (n >= PARALLEL_LENGTH) {
+		TaskGroup group(PolynomialParallel::pool());
+		group.run([&]() { karatsuba(a,     b,     h,  prod);         });
+		group.run([&]() { karatsuba(a + h, b + h, h2, prod + 2 * h); });
+		karatsuba(a_sum, b_sum, h2, middle.data());
+		group.wait();
+	}
+	else {
+		karatsuba(a,     b,     h,  prod);
+		karatsuba(a + h, b + h, h2, prod + 2 * h);
+		karatsuba(a_sum, b_sum, h2, middle.data());
+	}
+
+	// (a0 + a1)(b0 + b1) - a0 b0 - a1 b1
+	for (int i = 0; i < 2 * h - 1; i++) {
+		middle[i] -= prod[i];
+	}
+	for (int i = 0; i < 2 * h2 - 1; i++) {
+		middle[i] -= prod[2 * h + i];
+	}
+	for (int i = 0; i < 2 * h2 - 1; i++) {
+		prod[h + i] += middle[i];
+	}
+}
+
+/* произведение блока длинного множителя на короткий множитель */
+static void multiply_block(const float* a, int n1, const float* b, int n2, float* prod) {
+	if (n2 <= KARATSUBA_BASE) {
+		schoolbook(a, n1, b, n2, prod);
+		return;
+	}
+	if (n1 == n2) {
+		karatsuba(a, b, n2, prod);
+		return;
+	}
+
+	// последний блок короче множителя : дополняется нулями
+	std::vector<float> padded(a, a + n1);
+	padded.resize(n2, 0.0f);
+
+	std::vector<float> full(2 * n2 - 1);
+	karatsuba(padded.data(), b, n2, full.data());
+	std::copy(full.begin(), full.begin() + n1 + n2 - 1, prod);
+}
+
+void PolynomialParallel::multiply_dense(const float* a, int n1, const float* b, int n2, float* prod) {
+	if (n1 < n2) {
+		std::swap(a, b);
+		std::swap(n1, n2);
+	}
+
+	int chunk = n2 <= KARATSUBA_BASE ? MULT_CHUNK : n2;
+	if (n1 <= chunk) {
+		multiply_block(a, n1, b, n2, prod);
+		return;
+	}
+
+	// блоки длинного множителя умножаются независимо, затем частичные произведения складываются
+	int count_blocks = (n1 + chunk - 1) / chunk;
+	std::vector<std::vector<float>> partial(count_blocks);
+	{
+		TaskGroup group(pool());
+		for (int block = 0; block < count_blocks; block++) {
+			group.run([&, block]() {
+				int start = block * chunk;
+				int len   = std::min(chunk, n1 - start);
+
+				partial[block].resize(len + n2 - 1);
+				multiply_block(a + start, len, b, n2, partial[block].data());
+			});
+		}
+		group.wait();
+	}
+
+	std::fill(prod, prod + n1 + n2 - 1, 0.0f);
+	for (int block = 0; block < count_blocks; block++) {
+		float* dst = prod + block * chunk;
+		for (int i = 0; i < partial[block].size(); i++) {
+			dst[i] += partial[block][i];
+		}
+	}
+}
+
+Polynomial PolynomialParallel::multiply(const Polynomial& multed1, const Polynomial& multed2) {
+	std::vector<float> a = to_dense(multed1);
+	std::vector<float> b = to_dense(multed2);
+
+	std::vector<float> prod(a.size() + b.size() - 1);
+	multiply_dense(a.data(), a.size(), b.data(), b.size(), prod.data());
+
+	return from_dense(prod.data(), prod.size());
+}
+
+// ---------------------------------------
+// деление
+// ---------------------------------------
+
+void PolynomialParallel::divide(const Polynomial& dividend, const Polynomial& divisor, Polynomial* quot, Polynomial* remainder) {
+	std::vector<float> r = to_dense(dividend);
+	std::vector<float> d = to_dense(divisor);
+
+	int n = r.size() - 1, m = d.size() - 1;
+	if (n < m) {
+		if (quot)      *quot = Polynomial();
+		if (remainder) *remainder = dividend;
+		return;
+	}
+
+	float lead = d[m];
+	std::vector<float> q(n - m + 1, 0.0f);
+
+	int count_threads = pool().size();
+	int range_chunk = std::max(PARALLEL_LENGTH, (m + count_threads - 1) / count_threads);
+
+	for (int k1 = n - m; k1 >= 0; k1 -= DIVISION_BLOCK) {
+		int k0 = std::max(0, k1 - DIVISION_BLOCK + 1);
+
+		/* коэффициенты частного блока : вычитание ведётся только в верхнем окне [k0 + m, k1 + m],
+		*  от которого зависят следующие коэффициенты этого же блока */
+		for (int k = k1; k >= k0; k--) {
+			q[k] = r[k + m] / lead;
+			r[k + m] = 0;
+
+			for (int p = std::max(k0 + m, k); p < k + m; p++) {
+				r[p] -= q[k] * d[p - k];
+			}
+		}
+
+		/* вычитание блока частного, умноженного на делитель, из позиций [k0, k0 + m) ;
+		*  позиции делятся между потоками, каждый поток пишет только в свои */
+		auto subtract_range = [&](int j0, int j1) {
+			for (int k = k0; k <= k1; k++) {
+				float  q_k = q[k];
+				int    lo = std::max(j0, k), hi = std::min(j1, k + m);
+				for (int j = lo; j < hi; j++) {
+					r[j] -= q_k * d[j - k];
+				}
+			}
+		};
+
+		if (m <= range_chunk) {
+			subtract_range(k0, k0 + m);
+			continue;
+		}
+
+		TaskGroup group(pool());
+		for (int j0 = k0; j0 < k0 + m; j0 += range_chunk) {
+			int j1 = std::min(j0 + range_chunk, k0 + m);
+			group.run([&subtract_range, j0, j1]() { subtract_range(j0, j1); });
+		}
+		group.wait();
+	}
+
+	if (quot)      *quot = from_dense(q.data(), q.size());
+	if (remainder) *remainder = from_dense(r.data(), m);
+}
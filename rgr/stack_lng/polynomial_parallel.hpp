@@ -0,0 +1,40 @@
+#pragma once
+
+#include "polynomial.hpp"
+#include "thread_pool.hpp"
+
+/* класс "параллельные ядра многочленов"
+*
+*  умножение и деление больших многочленов выполняются над плотными массивами коэффициентов :
+*      умножение --- алгоритм Карацубы, верхние уровни рекурсии которого выполняются параллельно,
+*                    неравные по длине множители разбиваются на блоки длины меньшего множителя ;
+*      деление   --- блочное деление уголком : частное считается блоками по DIVISION_BLOCK коэффициентов,
+*                    а вычитание блока частного, умноженного на делитель, распределяется по потокам
+*
+*  операторы Polynomial сами обращаются к этим ядрам, если степень операнда не меньше порога ;
+*  меньшие многочлены обрабатываются прежними последовательными алгоритмами */
+class PolynomialParallel {
+public:
+	// количество потоков (0 : по количеству ядер) ; нельзя менять во время вычислений
+	static void set_threads(int count_threads);
+	static int  threads();
+
+	// порог : наименьшая степень операнда, при которой используются эти ядра
+	static void set_threshold(int degree);
+	static int  threshold();
+
+	// нужно ли использовать ядра для операндов данных степеней
+	static bool worth(int deg1, int deg2);
+
+	static Polynomial multiply(const Polynomial& multed1, const Polynomial& multed2);
+
+	// деление с остатком ; quot и remainder могут быть nullptr
+	static void divide(const Polynomial& dividend, const Polynomial& divisor, Polynomial* quot, Polynomial* remainder);
+
+	/* плотное произведение : prod[0 .. n1 + n2 - 2] = a[0 .. n1 - 1] * b[0 .. n2 - 1]
+	*  (prod перезаписывается) */
+	static void multiply_dense(const float* a, int n1, const float* b, int n2, float* prod);
+
+	// общий пул потоков
+	static ThreadPool& pool();
+};
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include "polynomial_roots.hpp"
+
+static const int    LANES           = PolynomialRoots::LANES;
+static const double STEP_TOLERANCE  = 1e-14;	// относительная величина шага, при которой итерации прекращаются
+static const double REAL_TOLERANCE  = 1e-5;		// относительная мнимая часть, при которой корень считается действительным
+static const int    NEWTON_STEPS    = 3;		// уточняющих шагов Ньютона для действительного корня
+
+/* многочлен, подготовленный к поиску корней : корень 0 отделён,
+*  коэффициенты поделены на старший (coeffs[k] при x^k, coeffs[degree] = 1) */
+struct PreparedPolynomial {
+	int                 index;			// номер многочлена в пакете
+	int                 zero_roots;		// кратность корня 0
+	int                 degree;			// степень после отделения корня 0 (-1 : нулевой многочлен)
+	std::vector<double> coeffs;
+	std::vector<double> roots;			// найденные действительные корни
+};
+
+static PreparedPolynomial prepare(const PolynomialView& view, int index) {
+	PreparedPolynomial prepared;
+	prepared.index = index;
+	prepared.zero_roots = 0;
+	prepared.degree = -1;
+
+	if (view.size() == 0) return prepared;
+
+	// термы представления упорядочены по возрастанию степеней
+	int low = view.power(0);
+	prepared.zero_roots = low;
+	prepared.degree = view.deg() - low;
+
+	double lead = view.coefficient(view.size() - 1);
+	prepared.coeffs.assign(prepared.degree + 1, 0.0);
+	for (int i = 0; i < view.size(); i++) {
+		prepared.coeffs[view.power(i) - low] = view.coefficient(i) / lead;
+	}
+
+	return prepared;
+}
+
+/* итерации Аберта --- Эрлиха для группы многочленов одной степени degree ;
+*  все массивы хранятся по дорожкам : элемент k дорожки lane лежит в [k * LANES + lane] */
+static void aberth_group(std::vector<PreparedPolynomial*>& group, int degree) {
+	int n = degree;
+	int count_active = group.size();
+
+	// неиспользуемые дорожки повторяют первую, чтобы в них не возникало бесконечностей
+	std::vector<double> a((n + 1) * LANES);
+	for (int lane = 0; lane < LANES; lane++) {
+		PreparedPolynomial* polynomial = group[lane < count_active ? lane : 0];
+		for (int k = 0; k <= n; k++) {
+			a[k * LANES + lane] = polynomial->coeffs[k];
+		}
+	}
+
+	// начальные приближения : точки окружности радиуса (|a0|)^(1/n), повёрнутые, чтобы не попасть на ось
+	std::vector<double> zr(n * LANES), zi(n * LANES);
+	for (int lane = 0; lane < LANES; lane++) {
+		double radius = std::pow(std::fabs(a[lane]), 1.0 / n);
+		if (radius == 0 || !std::isfinite(radius)) radius = 1;
+
+		for (int i = 0; i < n; i++) {
+			double angle = 2 * M_PI * i / n + 0.4;
+			zr[i * LANES + lane] = radius * std::cos(angle);
+			zi[i * LANES + lane] = radius * std::sin(angle);
+		}
+	}
+
+	double pr[LANES], pi[LANES], dr[LANES], di[LANES], sr[LANES], si[LANES], step[LANES];
+	for (int iteration = 0; iteration < PolynomialRoots::MAX_ITERATIONS; iteration++) {
+		for (int lane = 0; lane < LANES; lane++) step[lane] = 0;
+
+		for (int i = 0; i < n; i++) {
+			double* zr_i = &zr[i * LANES];
+			double* zi_i = &zi[i * LANES];
+
+			// p(z_i) и p'(z_i) по схеме Горнера
+			for (int lane = 0; lane < LANES; lane++) {
+				pr[lane] = 1; pi[lane] = 0;
+				dr[lane] = 0; di[lane] = 0;
+			}
+			for (int k = n - 1; k >= 0; k--) {
+				const double* a_k = &a[k * LANES];
+				for (int lane = 0; lane < LANES; lane++) {
+					double new_dr = dr[lane] * zr_i[lane] - di[lane] * zi_i[lane] + pr[lane];
+					double new_di = dr[lane] * zi_i[lane] + di[lane] * zr_i[lane] + pi[lane];
+					double new_pr = pr[lane] * zr_i[lane] - pi[lane] * zi_i[lane] + a_k[lane];
+					double new_pi = pr[lane] * zi_i[lane] + pi[lane] * zr_i[lane];
+					dr[lane] = new_dr; di[lane] = new_di;
+					pr[lane] = new_pr; pi[lane] = new_pi;
+				}
+			}
+
+			// сумма 1 / (z_i - z_j) по j != i
+			for (int lane = 0; lane < LANES; lane++) {
+				sr[lane] = 0; si[lane] = 0;
+			}
+			for (int j = 0; j < n; j++) {
+				if (j == i) continue;
+
+				const double* zr_j = &zr[j * LANES];
+				const double* zi_j = &zi[j * LANES];
+				for (int lane = 0; lane < LANES; lane++) {
+					double dzr = zr_i[lane] - zr_j[lane];
+					double dzi = zi_i[lane] - zi_j[lane];
+					double inv = 1 / (dzr * dzr + dzi * dzi);
+					sr[lane] += dzr * inv;
+					si[lane] -= dzi * inv;
+				}
+			}
+
+			// поправка w = N / (1 - N S), где N = p / p'
+			for (int lane = 0; lane < LANES; lane++) {
+				double den = dr[lane] * dr[lane] + di[lane] * di[lane];
+				double nr = (pr[lane] * dr[lane] + pi[lane] * di[lane]) / den;
+				double ni = (pi[lane] * dr[lane] - pr[lane] * di[lane]) / den;
+
+				double qr = 1 - (nr * sr[lane] - ni * si[lane]);
+				double qi =   - (nr * si[lane] + ni * sr[lane]);
+				double q_den = qr * qr + qi * qi;
+				double wr = (nr * qr + ni * qi) / q_den;
+				double wi = (ni * qr - nr * qi) / q_den;
+
+				if (!std::isfinite(wr) || !std::isfinite(wi)) { wr = 0; wi = 0; }
+
+				zr_i[lane] -= wr;
+				zi_i[lane] -= wi;
+
+				double scale = std::max(1.0, std::fabs(zr_i[lane]) + std::fabs(zi_i[lane]));
+				step[lane] = std::max(step[lane], (std::fabs(wr) + std::fabs(wi)) / scale);
+			}
+		}
+
+		bool converged = true;
+		for (int lane = 0; lane < count_active; lane++) {
+			if (step[lane] > STEP_TOLERANCE) converged = false;
+		}
+		if (converged) break;
+	}
+
+	// отбор действительных корней и уточнение методом Ньютона
+	for (int lane = 0; lane < count_active; lane++) {
+		PreparedPolynomial& polynomial = *group[lane];
+
+		for (int i = 0; i < n; i++) {
+			double x  = zr[i * LANES + lane];
+			double im = zi[i * LANES + lane];
+			if (std::fabs(im) > REAL_TOLERANCE * (1 + std::fabs(x))) continue;
+
+			for (int s = 0; s < NEWTON_STEPS; s++) {
+				double p = 1, d = 0;
+				for (int k = n - 1; k >= 0; k--) {
+					d = d * x + p;
+					p = p * x + polynomial.coeffs[k];
+				}
+				if (d == 0) break;
+				x -= p / d;
+			}
+
+			polynomial.roots.push_back(x);
+		}
+	}
+}
+
+static std::vector<std::vector<float>> find_roots(std::vector<PreparedPolynomial>& prepared) {
+	// многочлены одной степени собираются в группы по LANES штук
+	std::map<int, std::vector<PreparedPolynomial*>> by_degree;
+	for (PreparedPolynomial& polynomial : prepared) {
+		if (polynomial.degree > 0) by_degree[polynomial.degree].push_back(&polynomial);
+	}
+
+	for (auto& same_degree : by_degree) {
+		std::vector<PreparedPolynomial*>& polynomials = same_degree.second;
+
+		for (int first = 0; first < polynomials.size(); first += LANES) {
+			std::vector<PreparedPolynomial*> group(polynomials.begin() + first,
+												   polynomials.begin() + std::min<int>(first + LANES, polynomials.size()));
+			aberth_group(group, same_degree.first);
+		}
+	}
+
+	std::vector<std::vector<float>> roots(prepared.size());
+	for (PreparedPolynomial& polynomial : prepared) {
+		std::vector<float>& polynomial_roots = roots[polynomial.index];
+
+		polynomial_roots.assign(polynomial.zero_roots, 0.0f);
+		for (double root : polynomial.roots) {
+			polynomial_roots.push_back(root);
+		}
+
+		std::sort(polynomial_roots.begin(), polynomial_roots.end());
+	}
+
+	return roots;
+}
+
+std::vector<float> PolynomialRoots::real_roots(const PolynomialView& polynomial) {
+	std::vector<PreparedPolynomial> prepared;
+	prepared.push_back(prepare(polynomial, 0));
+
+	return find_roots(prepared)[0];
+}
+
+std::vector<float> PolynomialRoots::real_roots(const Polynomial& polynomial) {
+	// термы Polynomial могут быть не упорядочены : упорядочиваются при добавлении в пакет
+	PolynomialBatch batch;
+	batch.push_back(polynomial);
+
+	return real_roots(batch[0]);
+}
+
+std::vector<std::vector<float>> PolynomialRoots::real_roots(const PolynomialBatch& batch) {
+	std::vector<PreparedPolynomial> prepared;
+	prepared.reserve(batch.size());
+	for (int index = 0; index < batch.size(); index++) {
+		prepared.push_back(prepare(batch[index], index));
+	}
+
+	return find_roots(prepared);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <vector>
+#include "polynomial.hpp"
+#include "polynomial_view.hpp"
+#include "polynomial_batch.hpp"
+
+/* класс "поиск корней многочленов"
+*
+*  все комплексные корни находятся одновременно методом Аберта --- Эрлиха, затем отбираются
+*  действительные корни и уточняются методом Ньютона ; кратные корни повторяются
+*
+*  многочлены пакета одинаковой степени обрабатываются группами по LANES штук :
+*  данные группы хранятся по "дорожкам" (коэффициент k всех многочленов группы подряд),
+*  и самый внутренний цикл каждой итерации идёт по дорожкам, поэтому векторизуется */
+class PolynomialRoots {
+public:
+	static const int LANES = 8;				// многочленов в группе
+	static const int MAX_ITERATIONS = 200;	// наибольшее количество итераций Аберта --- Эрлиха
+
+	// действительные корни многочлена в порядке возрастания ; у нулевого многочлена корней нет
+	static std::vector<float> real_roots(const Polynomial& polynomial);
+	static std::vector<float> real_roots(const PolynomialView& polynomial);
+
+	// действительные корни каждого многочлена пакета
+	static std::vector<std::vector<float>> real_roots(const PolynomialBatch& batch);
+};
@@ -0,0 +1,215 @@
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include "polynomial_store.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static_assert(sizeof(StoreHeader) == 64, "размер заголовка хранилища входит в формат файла");
+
+static const char MAGIC[8] = { 'P', 'O', 'L', 'Y', 'S', 'T', 'O', 'R' };
+
+static const std::size_t COPY_BUFFER_BYTES = 1 << 20;
+
+static std::uint64_t align8(std::uint64_t offset) {
+	return (offset + 7) & ~(std::uint64_t)7;
+}
+
+// ---------------------------------------
+// чтение
+// ---------------------------------------
+
+PolynomialStore::PolynomialStore(const std::string& filename) : data(nullptr), length(0), handle(nullptr) {
+#ifdef _WIN32
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) throw 1;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart < (LONGLONG)sizeof(StoreHeader)) { CloseHandle(file); throw 1; }
+	length = file_size.QuadPart;
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(file);
+	if (!mapping) throw 1;
+
+	data = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data) { CloseHandle(mapping); throw 1; }
+	handle = mapping;
+#else
+	int fd = open(filename.c_str(), O_RDONLY);
+	if (fd < 0) throw 1;
+
+	struct stat file_stat;
+	if (fstat(fd, &file_stat) != 0 || file_stat.st_size < (off_t)sizeof(StoreHeader)) { close(fd); throw 1; }
+	length = file_stat.st_size;
+
+	void* mapping = mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (mapping == MAP_FAILED) throw 1;
+
+	data = (const char*)mapping;
+#endif
+
+	/* проверка заголовка и границ столбцов ; смещения сначала сравниваются друг с другом и с длиной файла,
+	*  а размеры столбцов --- делением, поэтому большие значения в повреждённом заголовке не переполняют проверку */
+	header = (const StoreHeader*)data;
+
+	bool valid = std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) == 0
+		&& header->version == VERSION
+		&& header->file_size == length
+		&& header->powers_offset >= sizeof(StoreHeader)
+		&& header->coefficients_offset % 8 == 0 && header->index_offset % 8 == 0
+		&& header->powers_offset <= header->coefficients_offset
+		&& header->coefficients_offset <= header->index_offset
+		&& header->index_offset <= length
+		&& header->count_terms <= (header->coefficients_offset - header->powers_offset) / sizeof(int)
+		&& header->count_terms <= (header->index_offset - header->coefficients_offset) / sizeof(float)
+		&& header->count_polynomials < (length - header->index_offset) / sizeof(std::uint64_t);
+	if (!valid) {
+		unmap();
+		throw 1;
+	}
+
+	powers       = (const int*)          (data + header->powers_offset);
+	coefficients = (const float*)        (data + header->coefficients_offset);
+	index        = (const std::uint64_t*)(data + header->index_offset);
+
+	/* индекс : от 0 до count_terms, не убывает, и термов в одном многочлене не больше, чем помещается в int
+	*  (PolynomialView) ; проверка читает весь индекс --- 8 байт на многочлен, столбцы термов не читаются */
+	bool valid_index = index[0] == 0 && index[header->count_polynomials] == header->count_terms;
+	for (std::uint64_t i = 0; valid_index && i < header->count_polynomials; i++) {
+		valid_index = index[i] <= index[i + 1] && index[i + 1] - index[i] <= INT_MAX;
+	}
+	if (!valid_index) {
+		unmap();
+		throw 1;
+	}
+}
+
+PolynomialStore::~PolynomialStore() {
+	unmap();
+}
+
+void PolynomialStore::unmap() {
+	if (!data) return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(data);
+	CloseHandle((HANDLE)handle);
+#else
+	munmap((void*)data, length);
+#endif
+	data = nullptr;
+}
+
+std::uint64_t PolynomialStore::size() const {
+	return header->count_polynomials;
+}
+std::uint64_t PolynomialStore::count_terms() const {
+	return header->count_terms;
+}
+
+PolynomialView PolynomialStore::operator [](std::uint64_t position) const {
+	std::uint64_t first = index[position];
+	return PolynomialView(powers + first, coefficients + first, index[position + 1] - first);
+}
+
+void PolynomialStore::advise(bool sequential) const {
+#ifndef _WIN32
+	madvise((void*)data, length, sequential ? MADV_SEQUENTIAL : MADV_RANDOM);
+#endif
+}
+
+// ---------------------------------------
+// запись
+// ---------------------------------------
+
+PolynomialStoreWriter::PolynomialStoreWriter(const std::string& _filename)
+	: filename(_filename), index(1, 0), finished(false) {
+	powers_stream.open(filename, std::ios::binary | std::ios::trunc);
+	coefficients_stream.open(filename + ".coeffs", std::ios::binary | std::ios::trunc);
+	if (!powers_stream || !coefficients_stream) throw 1;
+
+	// место под заголовок ; он заполняется в finish()
+	StoreHeader header = {};
+	powers_stream.write((const char*)&header, sizeof(header));
+}
+
+PolynomialStoreWriter::~PolynomialStoreWriter() {
+	if (finished) return;
+
+	// незаконченный файл не оставляем
+	powers_stream.close();
+	coefficients_stream.close();
+	std::remove((filename + ".coeffs").c_str());
+	std::remove(filename.c_str());
+}
+
+void PolynomialStoreWriter::push_back(const Polynomial& polynomial) {
+	normalized.clear();
+	normalized.push_back(polynomial);
+	push_back(normalized[0]);
+}
+void PolynomialStoreWriter::push_back(const PolynomialView& view) {
+	if (finished) throw 1;
+
+	powers_stream.write((const char*)view.powers_data(), view.size() * sizeof(int));
+	coefficients_stream.write((const char*)view.coefficients_data(), view.size() * sizeof(float));
+	if (!powers_stream || !coefficients_stream) throw 1;
+
+	index.push_back(index.back() + view.size());
+}
+void PolynomialStoreWriter::push_back(const PolynomialBatch& batch) {
+	for (int i = 0; i < batch.size(); i++) {
+		push_back(batch[i]);
+	}
+}
+
+std::uint64_t PolynomialStoreWriter::size() const {
+	return index.size() - 1;
+}
+
+void PolynomialStoreWriter::finish() {
+	if (finished) return;
+
+	StoreHeader header = {};
+	std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+	header.version             = PolynomialStore::VERSION;
+	header.count_polynomials   = size();
+	header.count_terms         = index.back();
+	header.powers_offset       = sizeof(StoreHeader);
+	header.coefficients_offset = align8(header.powers_offset + header.count_terms * sizeof(int));
+	header.index_offset        = align8(header.coefficients_offset + header.count_terms * sizeof(float));
+	header.file_size           = header.index_offset + index.size() * sizeof(std::uint64_t);
+
+	static const char zeros[8] = {};
+	powers_stream.write(zeros, header.coefficients_offset - (header.powers_offset + header.count_terms * sizeof(int)));
+
+	// столбец коэффициентов переписывается из временного файла блоками
+	coefficients_stream.close();
+	std::ifstream coefficients_in(filename + ".coeffs", std::ios::binary);
+	std::vector<char> buffer(COPY_BUFFER_BYTES);
+	while (coefficients_in) {
+		coefficients_in.read(buffer.data(), buffer.size());
+		powers_stream.write(buffer.data(), coefficients_in.gcount());
+	}
+	coefficients_in.close();
+	std::remove((filename + ".coeffs").c_str());
+
+	powers_stream.write(zeros, header.index_offset - (header.coefficients_offset + header.count_terms * sizeof(float)));
+	powers_stream.write((const char*)index.data(), index.size() * sizeof(std::uint64_t));
+
+	powers_stream.seekp(0);
+	powers_stream.write((const char*)&header, sizeof(header));
+	powers_stream.close();
+	if (powers_stream.fail()) throw 1;
+
+	finished = true;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "polynomial.hpp"
+#include "polynomial_view.hpp"
+#include "polynomial_batch.hpp"
+
+/* файл-хранилище многочленов : те же три столбца, что и в PolynomialBatch, но на диске
+*
+*  формат файла (все числа --- в порядке байтов машины, записавшей файл) :
+*      заголовок       :    StoreHeader (64 байта)
+*      степени         :    int32   [count_terms]
+*      коэффициенты    :    float32 [count_terms]           (начало выровнено по 8 байт)
+*      индекс          :    uint64  [count_polynomials + 1] (начало выровнено по 8 байт) ;
+*                           термы i-го многочлена --- позиции index[i] ... index[i + 1] - 1 столбцов
+*
+*  внутри многочлена термы упорядочены по возрастанию степеней и не содержат нулевых коэффициентов,
+*  поэтому многочлен из файла можно сразу использовать как PolynomialView */
+struct StoreHeader {
+	char          magic[8];					// "POLYSTOR"
+	std::uint32_t version;
+	std::uint32_t reserved;
+	std::uint64_t count_polynomials;
+	std::uint64_t count_terms;
+	std::uint64_t powers_offset;			// смещения столбцов от начала файла
+	std::uint64_t coefficients_offset;
+	std::uint64_t index_offset;
+	std::uint64_t file_size;
+};
+
+/* класс "хранилище многочленов, отображённое в память" (только чтение)
+*
+*  файл не читается целиком : операционная система подгружает страницы при обращении,
+*  поэтому файл может быть больше оперативной памяти ; operator[] ничего не копирует,
+*  возвращаемые представления действительны, пока существует хранилище
+*
+*  при ошибке открытия или повреждённом файле выбрасывается исключение 1 */
+class PolynomialStore {
+private:
+	const char*          data;			// начало отображения
+	std::uint64_t        length;		// длина отображения в байтах
+	void*                handle;		// дескриптор отображения (нужен только в Windows)
+
+	const StoreHeader*   header;
+	const int*           powers;
+	const float*         coefficients;
+	const std::uint64_t* index;
+
+	void unmap();
+public:
+	static const std::uint32_t VERSION = 1;
+
+	PolynomialStore(const std::string& filename);
+	PolynomialStore(const PolynomialStore&) = delete;
+	PolynomialStore& operator =(const PolynomialStore&) = delete;
+	~PolynomialStore();
+
+	std::uint64_t size() const;
+	std::uint64_t count_terms() const;
+
+	PolynomialView operator [](std::uint64_t index) const;
+
+	/* подсказка операционной системе о порядке обращений :
+	*  sequential --- просмотр подряд (упреждающее чтение), иначе --- произвольный доступ */
+	void advise(bool sequential) const;
+};
+
+/* класс "потоковая запись хранилища"
+*
+*  степени пишутся сразу в итоговый файл, коэффициенты --- во временный файл <имя>.coeffs,
+*  в памяти остаётся только индекс (8 байт на многочлен) ; finish() дописывает коэффициенты
+*  и индекс и заполняет заголовок ; без вызова finish() файл не считается записанным
+*
+*  при ошибке записи выбрасывается исключение 1 */
+class PolynomialStoreWriter {
+private:
+	std::string                filename;
+	std::ofstream              powers_stream;
+	std::ofstream              coefficients_stream;
+	std::vector<std::uint64_t> index;
+	PolynomialBatch            normalized;		// буфер для упорядочивания термов одного многочлена
+	bool                       finished;
+public:
+	PolynomialStoreWriter(const std::string& _filename);
+	PolynomialStoreWriter(const PolynomialStoreWriter&) = delete;
+	PolynomialStoreWriter& operator =(const PolynomialStoreWriter&) = delete;
+	~PolynomialStoreWriter();
+
+	// добавление многочлена в конец хранилища (термы Polynomial упорядочиваются, как в PolynomialBatch)
+	void push_back(const Polynomial& polynomial);
+	void push_back(const PolynomialView& view);
+	void push_back(const PolynomialBatch& batch);
+
+	std::uint64_t size() const;
+
+	void finish();
+};
@@ -0,0 +1,105 @@
+#include <iostream>
+#include "polynomial_view.hpp"
+
+PolynomialView::PolynomialView(const int* _powers, const float* _coefficients, int _count_terms)
+	: powers(_powers), coefficients(_coefficients), count_terms(_count_terms) {}
+
+int PolynomialView::size() const {
+	return count_terms;
+}
+int PolynomialView::power(int term_index) const {
+	return powers[term_index];
+}
+float PolynomialView::coefficient(int term_index) const {
+	return coefficients[term_index];
+}
+
+const int* PolynomialView::powers_data() const {
+	return powers;
+}
+const float* PolynomialView::coefficients_data() const {
+	return coefficients;
+}
+
+float PolynomialView::operator ()(float x) const {
+	float eval = 0;
+	float term_value;
+
+	for (int i = 0; i < count_terms; i++) {
+		term_value = coefficients[i];
+		for (int j = 0; j < powers[i]; j++) {
+			term_value *= x;
+		}
+
+		eval += term_value;
+	}
+
+	return eval;
+}
+
+float PolynomialView::operator [](int power) const {
+	if (power < 0) return 0;
+
+	// термы упорядочены по степеням : двоичный поиск
+	int left = 0, right = count_terms - 1, middle;
+	while (left <= right) {
+		middle = (left + right) / 2;
+
+		if (powers[middle] == power) return coefficients[middle];
+
+		if (powers[middle] < power) left  = middle + 1;
+		else                        right = middle - 1;
+	}
+
+	return 0;
+}
+
+int PolynomialView::deg() const {
+	if (count_terms == 0) return 0;
+
+	return powers[count_terms - 1];
+}
+
+PolynomialView::operator Polynomial() const {
+	return Polynomial(powers, coefficients, count_terms);
+}
+
+bool PolynomialView::operator ==(const PolynomialView& view) const {
+	if (count_terms != view.count_terms) return false;
+
+	for (int i = 0; i < count_terms; i++) {
+		if (powers[i] != view.powers[i] || coefficients[i] != view.coefficients[i]) return false;
+	}
+
+	return true;
+}
+bool PolynomialView::operator !=(const PolynomialView& view) const {
+	return !(*this == view);
+}
+
+std::ostream& operator <<(std::ostream& stream, const PolynomialView& view) {
+	stream << '[';
+
+	char sign; float coeff;
+	for (int i = 0; i < view.count_terms; i++) {
+		coeff = view.coefficients[i];
+
+		if (coeff > 0) {
+			sign = '+';
+		}
+		else {
+			sign = '-';
+			coeff = -coeff;
+		}
+
+		stream << sign << view.powers[i] << " : " << coeff;
+
+		if (i != view.count_terms - 1) {
+			stream << ' ';
+		}
+	}
+
+	stream << ']';
+
+	return stream;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <iostream>
+#include "polynomial.hpp"
+
+/* класс "представление многочлена" : многочлен, термы которого лежат в чужих массивах
+*  (в пакете многочленов, в отображённом в память файле и т. п.) ; ничего не копирует и не владеет памятью
+*
+*  термы хранятся в порядке возрастания степеней, нулевых коэффициентов нет,
+*  поэтому степень многочлена --- это степень последнего терма */
+class PolynomialView {
+private:
+	const int*   powers;		// степени термов
+	const float* coefficients;	// коэффициенты термов
+	int          count_terms;	// количество термов
+public:
+	PolynomialView(const int* _powers = nullptr, const float* _coefficients = nullptr, int _count_terms = 0);
+
+	// доступ к термам
+	int   size() const;
+	int   power(int term_index) const;
+	float coefficient(int term_index) const;
+
+	const int*   powers_data() const;
+	const float* coefficients_data() const;
+
+	// нахождение значения многочлена при заданном x
+	float operator ()(float x) const;
+
+	// возвращает коэффициент при заданной степени
+	float operator [](int power) const;
+
+	// степень многочлена
+	int deg() const;
+
+	// копирование в обычный многочлен
+	operator Polynomial() const;
+
+	bool operator ==(const PolynomialView& view) const;
+	bool operator !=(const PolynomialView& view) const;
+
+	// вывод в том же формате, что и у Polynomial : [±0 : a0 ±1 : a1 ±2 : a2 ...]
+	friend std::ostream& operator <<(std::ostream& stream, const PolynomialView& view);
+};
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "verifier.cpp"
+
+/* профиль исполнения программы : для каждой команды байт-кода (по смещению) --- сколько раз она исполнена,
+*  сколько времени заняла и сколько из этого времени --- операции над многочленами (команды, у которых
+*  хотя бы один операнд --- многочлен) ; время --- в наносекундах, вместе с замером часов */
+struct ExecutionProfile {
+	std::vector<long long> counts;
+	std::vector<long long> times;
+	std::vector<long long> kernel_times;
+
+	void reset(int code_size) {
+		counts.assign(code_size, 0);
+		times.assign(code_size, 0);
+		kernel_times.assign(code_size, 0);
+	}
+};
+
+/* класс "отчёт профилировщика" : профиль команд собирается по строкам исходной программы
+*  (время строки --- сумма времён её команд, исполнений --- наибольшее количество исполнений её команды)
+*
+*  print_listing    :    исполняемые лексемы, как в pinput_exe, с исполнениями, временем и долей общего времени ;
+*                        в конце --- время операций над многочленами по видам операций
+*  print_folded     :    свёрнутые стеки для построения flame graph (flamegraph.pl, speedscope) :
+*                        строка "программа;строка;операция время" */
+class Profiler {
+private:
+	// лексема так же, как в pinput_exe
+	static std::string token_text(const ParsedProgram& program, const Token& token) {
+		std::ostringstream stream;
+		stream << token;
+		if (token.token_class == Push || token.token_class == Pop || token.token_class == Jmp || token.token_class == Ji) {
+			stream << " (" << program.name_table[token.value] << ')';
+		}
+		return stream.str();
+	}
+
+	static bool executable(const Token& token) {
+		return token.token_class != Comment && token.token_class != Error && token.token_class != EndOfFile;
+	}
+
+	static void print_row(std::ostream& stream, long long count, long long time, long long total, const std::string& text) {
+		stream.setf(std::ios::right, std::ios::adjustfield);
+		stream.setf(std::ios::fixed, std::ios::floatfield);
+		stream.precision(1);
+
+		stream.width(13); stream << count;
+		stream.width(18); stream << time;
+		stream.width(9);  stream << (total ? 100.0 * time / total : 0.0) << '%';
+		stream << "    " << text << '\n';
+	}
+public:
+	// команда с видом операции (для суперкоманд и специализированных команд)
+	static std::string operation_name(const Bytecode& bytecode, int offset) {
+		OpCode op = (OpCode)bytecode.code[offset];
+
+		std::string name = Bytecode::name(op);
+		const char* kinds = Bytecode::operand_kinds(op);
+		for (int i = 0; kinds[i]; i++) {
+			if (kinds[i] == 'o') name += std::string(" ") + Bytecode::name((OpCode)bytecode.code[offset + 1 + i]);
+		}
+		return name;
+	}
+
+	// исполняемые лексемы по номерам строк (так же, как в pinput_exe)
+	static std::map<int, std::string> line_texts(const ParsedProgram& program) {
+		std::map<int, std::string> texts;
+		for (const Token& token : program.tokens) {
+			if (executable(token)) texts[token.line] = token_text(program, token);
+		}
+		return texts;
+	}
+
+	static void print_listing(const ParsedProgram& program, const Bytecode& bytecode, const ExecutionProfile& profile,
+							  std::ostream& stream = std::cout) {
+		std::map<int, long long> line_counts, line_times;
+		std::map<std::string, std::pair<long long, long long>> kernels;		// операция -> (исполнений, время)
+		long long total = 0;
+
+		for (int offset = 0; offset < bytecode.code.size(); offset += Bytecode::length((OpCode)bytecode.code[offset])) {
+			if (profile.counts[offset] == 0) continue;
+
+			int line = bytecode.lines[offset];
+			line_counts[line] = std::max(line_counts[line], profile.counts[offset]);
+			line_times[line] += profile.times[offset];
+			total += profile.times[offset];
+
+			if (profile.kernel_times[offset] > 0) {
+				std::pair<long long, long long>& kernel = kernels[operation_name(bytecode, offset)];
+				kernel.first  += profile.counts[offset];
+				kernel.second += profile.kernel_times[offset];
+			}
+		}
+
+		stream << "Профиль исполнения программы " << program.program_name << " (время в наносекундах):\n";
+		stream << "   исполнений             время     доля    лексема\n";
+		for (const Token& token : program.tokens) {
+			if (!executable(token)) continue;
+
+			print_row(stream, line_counts[token.line], line_times[token.line], total, token_text(program, token));
+		}
+		stream << "Всего : " << total << " нс\n\n";
+
+		stream << "Операции над многочленами:\n";
+		stream << "   исполнений             время     доля    операция\n";
+		for (auto& kernel : kernels) {
+			print_row(stream, kernel.second.first, kernel.second.second, total, kernel.first);
+		}
+	}
+
+	static void print_folded(const ParsedProgram& program, const Bytecode& bytecode, const ExecutionProfile& profile,
+							 std::ostream& stream = std::cout) {
+		std::map<int, std::string> line_frames = line_texts(program);
+
+		std::string root = program.program_name ? program.program_name : "program";
+		for (int offset = 0; offset < bytecode.code.size(); offset += Bytecode::length((OpCode)bytecode.code[offset])) {
+			if (profile.counts[offset] == 0) continue;
+
+			int line = bytecode.lines[offset];
+			std::string frame = root + ";" + (line_frames.count(line) ? line_frames[line] : "строка " + std::to_string(line));
+
+			long long self = profile.times[offset] - profile.kernel_times[offset];
+			if (self > 0) stream << frame << ' ' << self << '\n';
+			if (profile.kernel_times[offset] > 0) {
+				stream << frame << ';' << operation_name(bytecode, offset) << ' ' << profile.kernel_times[offset] << '\n';
+			}
+		}
+	}
+};
@@ -0,0 +1,326 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "compiler.cpp"
+
+/* кэш скомпилированной программы : байт-код записывается в файл рядом с исходным (<файл>.sbc),
+*  и следующий запуск с тем же исходным текстом и теми же параметрами компиляции берёт байт-код из файла,
+*  не разбирая и не компилируя программу
+*
+*  формат файла (все числа --- в порядке байтов машины, записавшей файл) :
+*      заголовок      :    ProgramCacheHeader
+*      код            :    uint32 размер, int32 [размер] слов кода, int32 [размер] номеров строк
+*      переменные     :    uint32 количество, для каждой --- uint32 длина имени и символы имени
+*      константы      :    uint32 количество, для каждой --- uint32 тип (ValueType) и значение :
+*                          число     --- int32 ;
+*                          многочлен --- uint32 количество термов, термы (int32 степень, float32 коэффициент) ;
+*                          многочлен от нескольких переменных --- uint32 количество термов,
+*                                      термы (uint64 одночлен, float32 коэффициент)
+*
+*  файл подходит, если совпадают версия формата, набор команд, параметры компиляции,
+*  хеш и длина исходного текста и хеш данных после заголовка ; VERSION нужно увеличивать
+*  при любом изменении компилятора, после которого тот же исходный текст даёт другой байт-код */
+struct ProgramCacheHeader {
+	char          magic[8];				// "STACKBC\0"
+	std::uint32_t version;
+	std::uint32_t count_opcodes;		// COUNT_OPCODES
+	std::uint32_t compile_flags;		// CompileFlags
+	std::int32_t  halt_offset;
+	std::uint64_t source_hash;			// FNV-1a исходного текста
+	std::uint64_t source_size;
+	std::uint64_t payload_hash;			// FNV-1a данных после заголовка
+	std::uint64_t payload_size;
+};
+
+class ProgramCache {
+private:
+	/* код из файла можно исполнять : коды команд и операнды в допустимых пределах,
+	*  переходы и halt_offset указывают на начало команды (шитый код есть только для начал команд) */
+	static bool valid_code(const Bytecode& bytecode) {
+		const std::vector<int>& code = bytecode.code;
+
+		std::vector<bool> instruction_start(code.size(), false);
+		std::vector<int>  targets;
+
+		int offset = 0;
+		while (offset < code.size()) {
+			if (code[offset] < 0 || code[offset] >= COUNT_OPCODES) return false;
+
+			OpCode op = (OpCode)code[offset];
+			if (offset + Bytecode::length(op) > code.size()) return false;
+			instruction_start[offset] = true;
+
+			const char* kinds = Bytecode::operand_kinds(op);
+			for (int i = 0; kinds[i]; i++) {
+				int operand = code[offset + 1 + i];
+				switch (kinds[i]) {
+				case 'c': if (operand < 0 || operand >= bytecode.constants.size())  return false; break;
+				case 's': if (operand < 0 || operand >= bytecode.slot_names.size()) return false; break;
+				case 'o': if (operand < 0 || operand >= COUNT_OPCODES)              return false; break;
+				case 't': targets.push_back(operand); break;
+				}
+			}
+			offset += Bytecode::length(op);
+		}
+
+		int halt = bytecode.halt_offset;
+		if (halt < 0 || halt >= code.size() || !instruction_start[halt] || code[halt] != OpHalt) return false;
+
+		for (int target : targets) {
+			if (target < 0 || target >= code.size() || !instruction_start[target]) return false;
+		}
+		return true;
+	}
+public:
+	static const std::uint32_t VERSION = 1;
+
+	/* запись значений в двоичном виде (константы кэша, снимки состояния интерпретатора) */
+	static void append(std::string& data, const void* value, std::size_t size) {
+		data.append((const char*)value, size);
+	}
+	static void append_u32(std::string& data, std::uint32_t value) {
+		append(data, &value, sizeof(value));
+	}
+
+	// последовательное чтение данных с проверкой границ
+	struct Reader {
+		const char* data;
+		std::size_t size;
+		std::size_t position;
+
+		bool get(void* value, std::size_t length) {
+			if (size - position < length) return false;
+			std::memcpy(value, data + position, length);
+			position += length;
+			return true;
+		}
+		bool get_u32(std::uint32_t& value) {
+			return get(&value, sizeof(value));
+		}
+	};
+
+	// объект : uint32 тип (ValueType) и значение (см. формат констант выше ; у Uninitialized значения нет)
+	static void append_object(std::string& data, const Object& obj) {
+		append_u32(data, (std::uint32_t)obj.get_type());
+		switch (obj.get_type()) {
+		case ValueType::Integer: {
+			std::int32_t value = obj.get_int();
+			append(data, &value, sizeof(value));
+			break;
+		}
+		case ValueType::Polynomial: {
+			std::size_t count_position = data.size();
+			append_u32(data, 0);
+
+			std::uint32_t count = 0;
+			for (auto& term : obj.get_polynomial()) {
+				std::int32_t power = term.power;
+				float        coeff = term.coefficient;
+				append(data, &power, sizeof(power));
+				append(data, &coeff, sizeof(coeff));
+				count++;
+			}
+			std::memcpy(&data[count_position], &count, sizeof(count));
+			break;
+		}
+		case ValueType::Multivariate: {
+			const MultiPolynomial& polynomial = obj.get_multivariate();
+
+			append_u32(data, polynomial.count_terms());
+			for (int i = 0; i < polynomial.count_terms(); i++) {
+				std::uint64_t monomial = polynomial.term_monomial(i);
+				float         coeff    = polynomial.term_coefficient(i);
+				append(data, &monomial, sizeof(monomial));
+				append(data, &coeff,    sizeof(coeff));
+			}
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	// чтение объекта ; false, если данные повреждены
+	static bool read_object(Reader& reader, Object& obj) {
+		std::uint32_t type;
+		if (!reader.get_u32(type)) return false;
+
+		switch ((ValueType)type) {
+		case ValueType::Integer: {
+			std::int32_t value;
+			if (!reader.get(&value, sizeof(value))) return false;
+			obj = Object((int)value);
+			return true;
+		}
+		case ValueType::Polynomial: {
+			std::uint32_t count;
+			if (!reader.get_u32(count) || count > reader.size) return false;
+
+			std::vector<int>   powers(count);
+			std::vector<float> coeffs(count);
+			for (std::uint32_t j = 0; j < count; j++) {
+				std::int32_t power;
+				if (!reader.get(&power, sizeof(power)) || !reader.get(&coeffs[j], sizeof(float))) return false;
+				powers[j] = power;
+			}
+			obj = Object(Polynomial(powers.data(), coeffs.data(), count));
+			return true;
+		}
+		case ValueType::Multivariate: {
+			std::uint32_t count;
+			if (!reader.get_u32(count) || count > reader.size) return false;
+
+			std::vector<MultiPolynomial::Monomial> monomials(count);
+			std::vector<float>                     coeffs(count);
+			for (std::uint32_t j = 0; j < count; j++) {
+				if (!reader.get(&monomials[j], sizeof(std::uint64_t)) || !reader.get(&coeffs[j], sizeof(float))) return false;
+			}
+			obj = Object(MultiPolynomial(monomials.data(), coeffs.data(), count));
+			return true;
+		}
+		case ValueType::Uninitialized:
+			obj = Object::uninitialized();
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// хеш FNV-1a (64 бита)
+	static std::uint64_t hash(const char* data, std::size_t size) {
+		std::uint64_t value = 14695981039346656037ull;
+		for (std::size_t i = 0; i < size; i++) {
+			value ^= (unsigned char)data[i];
+			value *= 1099511628211ull;
+		}
+		return value;
+	}
+
+	static std::string filename_for(const std::string& source_filename) {
+		return source_filename + ".sbc";
+	}
+
+	// содержимое файла целиком ; false, если файл не удалось прочитать
+	static bool read_file(const std::string& filename, std::string& contents) {
+		std::FILE* file = std::fopen(filename.c_str(), "rb");
+		if (!file) return false;
+
+		contents.clear();
+		char buffer[1 << 16];
+		std::size_t count;
+		while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) contents.append(buffer, count);
+
+		bool ok = !std::ferror(file);
+		std::fclose(file);
+		return ok;
+	}
+
+	/* запись файла целиком : файл сначала пишется под временным именем и затем переименовывается,
+	*  поэтому одновременно запущенные интерпретаторы не прочитают недописанный файл ; false при ошибке записи */
+	static bool write_file(const std::string& filename, const std::string& contents) {
+		std::string temporary = filename + ".tmp";
+		std::FILE* file = std::fopen(temporary.c_str(), "wb");
+		if (!file) return false;
+
+		bool ok = std::fwrite(contents.data(), 1, contents.size(), file) == contents.size();
+		ok = std::fclose(file) == 0 && ok;
+
+		if (ok && std::rename(temporary.c_str(), filename.c_str()) != 0) {
+			// в Windows rename не заменяет существующий файл
+			std::remove(filename.c_str());
+			ok = std::rename(temporary.c_str(), filename.c_str()) == 0;
+		}
+		if (!ok) std::remove(temporary.c_str());
+		return ok;
+	}
+
+	// запись байт-кода в файл (через write_file) ; false при ошибке записи
+	static bool save(const std::string& filename, const Bytecode& bytecode, const std::string& source, int compile_flags) {
+		std::string payload;
+
+		append_u32(payload, bytecode.code.size());
+		append(payload, bytecode.code.data(),  bytecode.code.size()  * sizeof(int));
+		append(payload, bytecode.lines.data(), bytecode.lines.size() * sizeof(int));
+
+		append_u32(payload, bytecode.slot_names.size());
+		for (const std::string& name : bytecode.slot_names) {
+			append_u32(payload, name.size());
+			payload += name;
+		}
+
+		append_u32(payload, bytecode.constants.size());
+		for (const Object& constant : bytecode.constants) append_object(payload, constant);
+
+		ProgramCacheHeader header;
+		std::memcpy(header.magic, "STACKBC", 8);
+		header.version       = VERSION;
+		header.count_opcodes = COUNT_OPCODES;
+		header.compile_flags = compile_flags;
+		header.halt_offset   = bytecode.halt_offset;
+		header.source_hash   = hash(source.data(), source.size());
+		header.source_size   = source.size();
+		header.payload_hash  = hash(payload.data(), payload.size());
+		header.payload_size  = payload.size();
+
+		std::string contents((const char*)&header, sizeof(header));
+		contents += payload;
+		return write_file(filename, contents);
+	}
+
+	// чтение байт-кода ; false, если файла нет, он записан для другого исходного текста или параметров или повреждён
+	static bool load(const std::string& filename, const std::string& source, int compile_flags, Bytecode& bytecode) {
+		std::string contents;
+		if (!read_file(filename, contents) || contents.size() < sizeof(ProgramCacheHeader)) return false;
+
+		ProgramCacheHeader header;
+		std::memcpy(&header, contents.data(), sizeof(header));
+
+		const char* payload      = contents.data() + sizeof(header);
+		std::size_t payload_size = contents.size() - sizeof(header);
+
+		bool valid = std::memcmp(header.magic, "STACKBC", 8) == 0
+			&& header.version       == VERSION
+			&& header.count_opcodes == COUNT_OPCODES
+			&& header.compile_flags == compile_flags
+			&& header.source_size   == source.size()
+			&& header.source_hash   == hash(source.data(), source.size())
+			&& header.payload_size  == payload_size
+			&& header.payload_hash  == hash(payload, payload_size);
+		if (!valid) return false;
+
+		Reader reader = { payload, payload_size, 0 };
+		Bytecode loaded;
+		loaded.halt_offset = header.halt_offset;
+
+		std::uint32_t code_size;
+		if (!reader.get_u32(code_size) || code_size > payload_size / sizeof(int)) return false;
+		loaded.code.resize(code_size);
+		loaded.lines.resize(code_size);
+		if (!reader.get(loaded.code.data(), code_size * sizeof(int)) || !reader.get(loaded.lines.data(), code_size * sizeof(int))) return false;
+
+		std::uint32_t count_slots;
+		if (!reader.get_u32(count_slots) || count_slots > payload_size) return false;
+		for (std::uint32_t i = 0; i < count_slots; i++) {
+			std::uint32_t length;
+			if (!reader.get_u32(length) || length > payload_size) return false;
+
+			std::string name(length, '\0');
+			if (!reader.get(&name[0], length)) return false;
+			loaded.slot_names.push_back(std::move(name));
+		}
+
+		std::uint32_t count_constants;
+		if (!reader.get_u32(count_constants) || count_constants > payload_size) return false;
+		for (std::uint32_t i = 0; i < count_constants; i++) {
+			Object constant;
+			if (!read_object(reader, constant) || constant.get_type() == ValueType::Uninitialized) return false;
+			loaded.constants.push_back(std::move(constant));
+		}
+
+		if (reader.position != payload_size || !valid_code(loaded)) return false;
+
+		bytecode = std::move(loaded);
+		return true;
+	}
+};
@@ -0,0 +1,145 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "interpreter.cpp"
+
+/* образ снимка состояния интерпретатора : снимок (InterpreterSnapshot) записывается в файл,
+*  и другой запуск той же программы продолжает исполнение с этого состояния
+*
+*  формат файла (все числа --- в порядке байтов машины, записавшей файл) :
+*      заголовок      :    SnapshotHeader
+*      значения       :    count_values объектов (как константы в ProgramCache) ; многочлен, который делят
+*                          несколько объектов снимка, записывается один раз
+*      стек           :    count_stack номеров значений (uint32), от дна к вершине
+*      переменные     :    count_slots номеров значений (uint32), по номерам ячеек
+*
+*  при чтении объекты с одним номером значения снова делят один блок многочлена ;
+*  образ подходит только для того же байт-кода : проверяются хеш и размер кода и количество ячеек ;
+*  программа, прошедшая проверку стека, исполняется без проверок размера стека, поэтому глубина стека
+*  в снимке должна совпадать с глубиной, найденной StackVerifier перед командой pc */
+struct SnapshotHeader {
+	char          magic[8];			// "STACKSN\0"
+	std::uint32_t version;
+	std::int32_t  pc;				// смещение следующей команды
+	std::uint64_t code_hash;		// FNV-1a слов кода
+	std::uint32_t code_size;
+	std::uint32_t count_slots;
+	std::uint32_t count_values;
+	std::uint32_t count_stack;
+	std::uint64_t payload_hash;		// FNV-1a данных после заголовка
+	std::uint64_t payload_size;
+};
+
+class SnapshotImage {
+private:
+	static std::uint64_t code_hash(const Bytecode& bytecode) {
+		return ProgramCache::hash((const char*)bytecode.code.data(), bytecode.code.size() * sizeof(int));
+	}
+
+	// смещение --- начало команды байт-кода
+	static bool instruction_start(const Bytecode& bytecode, int pc) {
+		for (int offset = 0; offset < bytecode.code.size(); offset += Bytecode::length((OpCode)bytecode.code[offset])) {
+			if (offset == pc) return true;
+		}
+		return false;
+	}
+public:
+	static const std::uint32_t VERSION = 1;
+
+	// запись снимка программы bytecode в файл ; false при ошибке записи
+	static bool save(const std::string& filename, const Bytecode& bytecode, const InterpreterSnapshot& snapshot) {
+		std::string values, references;
+		std::uint32_t count_values = 0;
+		std::unordered_map<const void*, std::uint32_t> shared;		// блок многочлена -> номер значения
+
+		auto add = [&](const Object& obj) {
+			std::uint32_t index = count_values;
+			if (obj.block()) {
+				auto found = shared.find(obj.block());
+				if (found != shared.end()) index = found->second;
+				else                       shared.emplace(obj.block(), index);
+			}
+			if (index == count_values) {
+				ProgramCache::append_object(values, obj);
+				count_values++;
+			}
+			ProgramCache::append_u32(references, index);
+		};
+		for (const Object& obj : snapshot.stack)     add(obj);
+		for (const Object& obj : snapshot.variables) add(obj);
+
+		std::string payload = values + references;
+
+		SnapshotHeader header;
+		std::memcpy(header.magic, "STACKSN", 8);
+		header.version      = VERSION;
+		header.pc           = snapshot.pc;
+		header.code_hash    = code_hash(bytecode);
+		header.code_size    = bytecode.code.size();
+		header.count_slots  = snapshot.variables.size();
+		header.count_values = count_values;
+		header.count_stack  = snapshot.stack.size();
+		header.payload_hash = ProgramCache::hash(payload.data(), payload.size());
+		header.payload_size = payload.size();
+
+		std::string contents((const char*)&header, sizeof(header));
+		contents += payload;
+		return ProgramCache::write_file(filename, contents);
+	}
+
+	// чтение снимка ; false, если файла нет, он записан для другой программы или повреждён
+	static bool load(const std::string& filename, const CompiledProgram& program, InterpreterSnapshot& snapshot) {
+		const Bytecode&   bytecode    = program.bytecode;
+		const StackCheck& stack_check = program.stack_check;
+
+		std::string contents;
+		if (!ProgramCache::read_file(filename, contents) || contents.size() < sizeof(SnapshotHeader)) return false;
+
+		SnapshotHeader header;
+		std::memcpy(&header, contents.data(), sizeof(header));
+
+		const char* payload      = contents.data() + sizeof(header);
+		std::size_t payload_size = contents.size() - sizeof(header);
+
+		bool valid = std::memcmp(header.magic, "STACKSN", 8) == 0
+			&& header.version      == VERSION
+			&& header.code_size    == bytecode.code.size()
+			&& header.code_hash    == code_hash(bytecode)
+			&& header.count_slots  == bytecode.slot_names.size()
+			&& header.payload_size == payload_size
+			&& header.payload_hash == ProgramCache::hash(payload, payload_size)
+			&& header.count_values <= payload_size
+			&& header.count_stack  <= payload_size
+			&& instruction_start(bytecode, header.pc)
+			&& (!stack_check.verified || stack_check.depths[header.pc] == (std::int64_t)header.count_stack);
+		if (!valid) return false;
+
+		ProgramCache::Reader reader = { payload, payload_size, 0 };
+
+		std::vector<Object> values(header.count_values);
+		for (Object& value : values) {
+			if (!ProgramCache::read_object(reader, value)) return false;
+		}
+
+		auto read_objects = [&](std::uint32_t count, std::vector<Object>& objects) {
+			objects.clear();
+			objects.reserve(count);
+			for (std::uint32_t i = 0; i < count; i++) {
+				std::uint32_t index;
+				if (!reader.get_u32(index) || index >= values.size()) return false;
+				objects.push_back(values[index]);
+			}
+			return true;
+		};
+
+		InterpreterSnapshot loaded;
+		loaded.pc = header.pc;
+		if (!read_objects(header.count_stack, loaded.stack) || !read_objects(header.count_slots, loaded.variables)) return false;
+		if (reader.position != payload_size) return false;
+
+		snapshot = std::move(loaded);
+		return true;
+	}
+};
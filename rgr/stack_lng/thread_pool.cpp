@@ -0,0 +1,142 @@
+#include <thread>
+#include "thread_pool.hpp"
+
+/* номер очереди текущего рабочего потока (-1 : поток не принадлежит пулу) */
+static thread_local const ThreadPool* current_pool = nullptr;
+static thread_local int               current_queue = -1;
+
+ThreadPool::ThreadPool(int count_threads) : pending(0), next_queue(0), stopping(false) {
+	if (count_threads < 1) count_threads = 1;
+
+	for (int i = 0; i < count_threads - 1; i++) {
+		queues.push_back(std::make_unique<WorkQueue>());
+	}
+	for (int i = 0; i < count_threads - 1; i++) {
+		workers.emplace_back(&ThreadPool::worker_loop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+
+	for (auto& worker : workers) {
+		worker.join();
+	}
+}
+
+int ThreadPool::size() const {
+	return workers.size() + 1;
+}
+
+void ThreadPool::submit(Task task) {
+	if (queues.empty()) {
+		task();
+		return;
+	}
+
+	int queue_index = (current_pool == this) ? current_queue : next_queue++ % queues.size();
+	{
+		std::lock_guard<std::mutex> lock(queues[queue_index]->mutex);
+		queues[queue_index]->tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		pending++;
+	}
+	wake.notify_one();
+}
+
+bool ThreadPool::pop_own(int queue_index, Task& task) {
+	WorkQueue& queue = *queues[queue_index];
+
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.tasks.empty()) return false;
+
+	task = std::move(queue.tasks.back());
+	queue.tasks.pop_back();
+	pending--;
+	return true;
+}
+
+bool ThreadPool::steal(int thief_index, Task& task) {
+	int count_queues = queues.size();
+	int start = thief_index < 0 ? 0 : thief_index + 1;
+
+	for (int i = 0; i < count_queues; i++) {
+		WorkQueue& queue = *queues[(start + i) % count_queues];
+
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty()) continue;
+
+		task = std::move(queue.tasks.front());
+		queue.tasks.pop_front();
+		pending--;
+		return true;
+	}
+
+	return false;
+}
+
+bool ThreadPool::run_one() {
+	if (pending == 0) return false;
+
+	Task task;
+	int own = (current_pool == this) ? current_queue : -1;
+
+	if ((own >= 0 && pop_own(own, task)) || steal(own, task)) {
+		task();
+		return true;
+	}
+
+	return false;
+}
+
+void ThreadPool::worker_loop(int queue_index) {
+	current_pool  = this;
+	current_queue = queue_index;
+
+	while (true) {
+		if (run_one()) continue;
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		wake.wait(lock, [this]() { return stopping || pending > 0; });
+
+		if (stopping && pending == 0) return;
+	}
+}
+
+TaskGroup::TaskGroup(ThreadPool& _pool) : pool(_pool), unfinished(0) {}
+
+TaskGroup::~TaskGroup() {
+	wait();
+}
+
+void TaskGroup::run(ThreadPool::Task task) {
+	if (pool.size() == 1) {
+		task();
+		return;
+	}
+
+	unfinished++;
+	pool.submit([this, task = std::move(task)]() {
+		task();
+
+		// под mutex : ожидающий не вернётся из wait (и не разрушит группу), пока сигнал не отправлен
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--unfinished == 0) finished.notify_all();
+	});
+}
+
+void TaskGroup::wait() {
+	while (unfinished > 0) {
+		if (pool.run_one()) continue;
+
+		// задач в очередях нет : оставшиеся задачи группы уже выполняются другими потоками
+		std::unique_lock<std::mutex> lock(mutex);
+		finished.wait(lock, [this]() { return unfinished == 0; });
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* класс "пул потоков" с перехватом работы (work stealing)
+*
+*  у каждого рабочего потока своя очередь задач : поток берёт задачи с конца своей очереди,
+*  а при её опустошении крадёт задачи из начала чужих очередей ;
+*  задачи, поставленные не из рабочего потока, раскладываются по очередям по кругу
+*
+*  пул на count_threads потоков создаёт count_threads - 1 рабочих потоков :
+*  ещё одним считается поток, ожидающий группу задач, --- он выполняет задачи, пока ждёт */
+class ThreadPool {
+public:
+	using Task = std::function<void()>;
+
+	explicit ThreadPool(int count_threads);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator =(const ThreadPool&) = delete;
+
+	// общее количество потоков (вместе с ожидающим)
+	int size() const;
+
+	// поставить задачу в очередь
+	void submit(Task task);
+
+	// выполнить одну задачу из очередей, если она есть ; возвращает false, если задач нет
+	bool run_one();
+private:
+	struct WorkQueue {
+		std::deque<Task> tasks;
+		std::mutex       mutex;
+	};
+
+	std::vector<std::unique_ptr<WorkQueue>> queues;		// очереди рабочих потоков
+	std::vector<std::thread>                workers;	// рабочие потоки
+
+	std::atomic<int>        pending;		// количество задач в очередях
+	std::atomic<unsigned>   next_queue;		// очередь для задач извне пула
+	std::atomic<bool>       stopping;		// флаг завершения
+	std::mutex              sleep_mutex;
+	std::condition_variable wake;
+
+	bool pop_own(int queue_index, Task& task);
+	bool steal(int thief_index, Task& task);
+	void worker_loop(int queue_index);
+};
+
+/* класс "группа задач" : задачи, завершения которых нужно дождаться вместе
+*  при пуле из одного потока задачи выполняются сразу, внутри run */
+class TaskGroup {
+private:
+	ThreadPool&             pool;
+	std::atomic<int>        unfinished;
+	std::mutex              mutex;
+	std::condition_variable finished;		// сигнал, когда unfinished становится 0
+public:
+	explicit TaskGroup(ThreadPool& _pool);
+	~TaskGroup();
+
+	void run(ThreadPool::Task task);
+
+	/* ожидание завершения всех задач группы : пока в очередях есть задачи, ожидающий поток выполняет их сам,
+	*  а когда очереди пусты, засыпает до завершения последней задачи группы */
+	void wait();
+};
@@ -0,0 +1,96 @@
+#include <iostream>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "polynomial.hpp"
+#include "multivariate.hpp"
+#include "polynomial_roots.hpp"
+#include "tracer.cpp"
+
+/* 	программа выводит трассу исполнения (файл, записанный интерпретатором с INTERPRETER_TRACE 1)
+*	вместе с лексемами программы : программа разбирается и компилируется заново с теми же параметрами,
+*	что записаны в трассе, поэтому смещения команд в трассе совпадают со смещениями в байт-коде
+*
+*	параметры запуска : ./trace_decode.exe <файл программы> [файл трассы, по умолчанию pinput_trace]
+*/
+
+// типы двух верхних объектов стека из события трассы
+static std::string stack_types(int types) {
+	static const char* names[] = { "", "число", "многочлен", "многочлен от x0..", "нет значения" };
+
+	std::string text;
+	for (int i = 1; i >= 0; i--) {
+		int type = (types >> (3 * i)) & 7;
+		if (type == 0 || type > 4) continue;
+
+		if (!text.empty()) text += ", ";
+		text += names[type];
+	}
+	return text.empty() ? "-" : text;
+}
+
+// текст, дополненный пробелами до width символов (width потока считает байты, а не буквы UTF-8)
+static std::string pad(const std::string& text, int width) {
+	int length = 0;
+	for (char c : text) if ((c & 0xc0) != 0x80) length++;
+
+	return text + std::string(length < width ? width - length : 1, ' ');
+}
+
+int main(int argc, char* argv[]) {
+	if (argc < 2) {
+		std::cout << "Нужен файл программы...\n";
+		return 1;
+	}
+	const char* trace_filename = argc > 2 ? argv[2] : "pinput_trace";
+
+	TraceHeader             header;
+	std::vector<TraceEvent> events;
+	if (!TraceBuffer::load(trace_filename, header, events)) {
+		std::cout << "Не удалось прочитать трассу из файла " << trace_filename << "...\n";
+		return 1;
+	}
+
+	Parser parser;
+	ParsedProgram program = parser.run(argv[1]);
+
+	std::ostringstream errors;
+	if (program.print_errors(errors) != 0) {
+		std::cout << "Программа содержит ошибки...\n";
+		return 1;
+	}
+
+	Bytecode bytecode = Compiler::compile(program, header.compile_flags & CompileFused, header.compile_flags & CompileOptimized,
+										  header.compile_flags & CompileSpecialized);
+	if (bytecode.code.size() != header.code_size) {
+		std::cout << "Трасса записана для другой программы (размер байт-кода " << header.code_size
+				  << ", а не " << bytecode.code.size() << ")...\n";
+		return 1;
+	}
+
+	std::map<int, std::string> texts = Profiler::line_texts(program);
+
+	std::cout << "Трасса программы " << argv[1] << " : последние " << header.count << " из " << header.written << " команд\n";
+	std::cout << "       номер  смещение  команда                   глубина  верх стека                     лексема\n";
+
+	std::uint64_t number = header.written - header.count;
+	for (const TraceEvent& event : events) {
+		int offset = event.offset;
+		bool valid = offset >= 0 && offset < bytecode.code.size() && bytecode.code[offset] == event.op;
+
+		std::cout.setf(std::ios::right, std::ios::adjustfield);
+		std::cout.width(12); std::cout << number++;
+		std::cout.width(10); std::cout << offset << "  ";
+
+		std::cout << pad(valid ? Profiler::operation_name(bytecode, offset) : "?", 24);
+		std::cout.width(9);  std::cout << event.depth << "  ";
+		std::cout << pad(stack_types(event.types), 31);
+
+		if (valid) std::cout << texts[bytecode.lines[offset]];
+		std::cout << '\n';
+	}
+
+	return 0;
+}
@@ -0,0 +1,113 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include "profiler.cpp"
+
+/* трассировка исполнения : интерпретатор, собранный с INTERPRETER_TRACE 1, перед каждой командой
+*  записывает событие в кольцевой буфер ; в буфере остаются последние события, которые записываются в файл
+*  при ошибке выполнения или в конце работы и читаются программой trace_decode */
+#ifndef INTERPRETER_TRACE
+#define INTERPRETER_TRACE 0
+#endif
+
+/* событие трассы (8 байт) :
+*  offset    :    смещение команды в байт-коде
+*  op        :    код команды
+*  types     :    типы двух верхних объектов стека перед командой : по 3 бита, ValueType + 1 (0 --- объекта нет),
+*                 младшие биты --- вершина стека
+*  depth     :    глубина стека перед командой (65535 --- 65535 и больше) */
+struct TraceEvent {
+	std::int32_t  offset;
+	std::uint8_t  op;
+	std::uint8_t  types;
+	std::uint16_t depth;
+};
+
+/* заголовок файла трассы ; за ним следуют count событий от самого старого к самому новому */
+struct TraceHeader {
+	char          magic[4];			// "STRC"
+	std::uint32_t version;
+	std::uint32_t compile_flags;	// CompileFlags : по ним trace_decode компилирует программу заново
+	std::uint32_t code_size;		// размер байт-кода (проверка, что программа та же)
+	std::uint64_t written;			// всего записано событий (старые события перезаписаны)
+	std::uint64_t count;			// событий в файле
+};
+
+/* класс "кольцевой буфер трассы" : размер --- степень двойки, запись события --- одна запись в массив
+*  и увеличение счётчика, без блокировок : у каждого интерпретатора свой буфер и пишет в него один поток */
+class TraceBuffer {
+private:
+	std::vector<TraceEvent> events;
+	std::uint64_t           mask;
+	std::uint64_t           written;
+public:
+	static const std::uint32_t VERSION = 1;
+	static const std::size_t   DEFAULT_CAPACITY = 1 << 16;
+
+	explicit TraceBuffer(std::size_t capacity = DEFAULT_CAPACITY) {
+		reset(capacity);
+	}
+
+	// новый размер буфера (округляется вверх до степени двойки) ; записанные события отбрасываются
+	void reset(std::size_t capacity) {
+		std::size_t size = 1;
+		while (size < capacity) size <<= 1;
+
+		events.assign(size, TraceEvent{ 0, 0, 0, 0 });
+		mask    = size - 1;
+		written = 0;
+	}
+
+	void record(int offset, int op, std::size_t depth, int types) {
+		TraceEvent& event = events[written & mask];
+		event.offset = offset;
+		event.op     = (std::uint8_t)op;
+		event.types  = (std::uint8_t)types;
+		event.depth  = (std::uint16_t)(depth < 0xffff ? depth : 0xffff);
+		written++;
+	}
+
+	std::uint64_t count_written() const {
+		return written;
+	}
+
+	// запись в файл ; false, если файл не удалось записать
+	bool dump(const char* filename, int compile_flags, int code_size) const {
+		std::FILE* file = std::fopen(filename, "wb");
+		if (!file) return false;
+
+		std::uint64_t count = written < events.size() ? written : events.size();
+
+		TraceHeader header;
+		std::memcpy(header.magic, "STRC", 4);
+		header.version       = VERSION;
+		header.compile_flags = compile_flags;
+		header.code_size     = code_size;
+		header.written       = written;
+		header.count         = count;
+
+		bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+		for (std::uint64_t i = written - count; ok && i < written; i++) {
+			ok = std::fwrite(&events[i & mask], sizeof(TraceEvent), 1, file) == 1;
+		}
+
+		return std::fclose(file) == 0 && ok;
+	}
+
+	// чтение файла трассы ; false, если файл не открылся или это не трасса
+	static bool load(const char* filename, TraceHeader& header, std::vector<TraceEvent>& loaded) {
+		std::FILE* file = std::fopen(filename, "rb");
+		if (!file) return false;
+
+		bool ok = std::fread(&header, sizeof(header), 1, file) == 1
+			   && std::memcmp(header.magic, "STRC", 4) == 0 && header.version == VERSION;
+		if (ok) {
+			loaded.resize(header.count);
+			ok = std::fread(loaded.data(), sizeof(TraceEvent), loaded.size(), file) == loaded.size();
+		}
+
+		std::fclose(file);
+		return ok;
+	}
+};
@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include "program_cache.cpp"
+
+/* результат проверки стека программы
+*
+*  verified         :    перед каждой достижимой командой глубина стека одна и та же на всех путях,
+*                        и операндов для команды в стеке всегда достаточно ; такая программа
+*                        исполняется без проверок размера стека
+*  max_depth        :    наибольшая глубина стека (стек можно выделить один раз заранее)
+*  underflow_lines  :    строки, в которых команде не хватит операндов, если до неё дойдёт исполнение
+*  unknown_line     :    строка, после которой глубина стека неизвестна (roots или разная глубина
+*                        на разных путях, например, цикл, который кладёт в стек), -1 --- если такой нет
+*  depths           :    глубина стека перед командой с данным смещением (-1 --- команда не достигается) */
+struct StackCheck {
+	bool             verified = false;
+	int              max_depth = 0;
+	std::vector<int> underflow_lines;
+	int              unknown_line = -1;
+	std::vector<int> depths;
+
+	void print(std::ostream& stream = std::cout) const {
+		if (verified) {
+			stream << "Стек проверен : наибольшая глубина " << max_depth << '\n';
+			return;
+		}
+
+		for (int line : underflow_lines) {
+			stream << "Не хватает операндов в стеке в строке " << line << '\n';
+		}
+		if (unknown_line >= 0) {
+			stream << "Глубина стека неизвестна после строки " << unknown_line << " : стек проверяется во время выполнения\n";
+		}
+	}
+};
+
+/* класс "проверка стека" : глубина стека перед каждой командой байт-кода находится обходом графа переходов
+*  (jmp, ji и суперкоманды с переходом) от первой команды ; каждая команда требует и оставляет
+*  известное количество объектов (Bytecode::stack_inputs, Bytecode::stack_outputs)
+*
+*  команда, для которой не хватает операндов, отмечается, и путь через неё дальше не просматривается :
+*  во время выполнения на ней произойдёт ошибка и программа остановится */
+class StackVerifier {
+public:
+	static StackCheck verify(const Bytecode& bytecode) {
+		const std::vector<int>& code = bytecode.code;
+
+		StackCheck check;
+
+		// глубина стека перед командой с данным смещением (-1 --- команда ещё не достигнута)
+		std::vector<int> depth(code.size(), -1);
+		std::vector<int> worklist = { 0 };
+		depth[0] = 0;
+
+		auto visit = [&](int offset, int new_depth, int from_line) {
+			if (depth[offset] < 0) {
+				depth[offset] = new_depth;
+				worklist.push_back(offset);
+			}
+			else if (depth[offset] != new_depth && check.unknown_line < 0) {
+				check.unknown_line = from_line;
+			}
+		};
+
+		while (!worklist.empty()) {
+			int offset = worklist.back();
+			worklist.pop_back();
+
+			OpCode op   = (OpCode)code[offset];
+			int    line = bytecode.lines[offset];
+
+			if (depth[offset] < Bytecode::stack_inputs(op)) {
+				check.underflow_lines.push_back(line);
+				continue;
+			}
+			if (Bytecode::stack_outputs(op) < 0) {
+				if (check.unknown_line < 0) check.unknown_line = line;
+				continue;
+			}
+
+			int after = depth[offset] - Bytecode::stack_inputs(op) + Bytecode::stack_outputs(op);
+			check.max_depth = std::max(check.max_depth, after);
+
+			if (op == OpEnd || op == OpFail || op == OpHalt) continue;
+
+			const char* kinds = Bytecode::operand_kinds(op);
+			for (int i = 0; kinds[i]; i++) {
+				if (kinds[i] == 't') visit(code[offset + 1 + i], after, line);
+			}
+			if (op != OpJmp) visit(offset + Bytecode::length(op), after, line);
+		}
+
+		std::sort(check.underflow_lines.begin(), check.underflow_lines.end());
+		check.underflow_lines.erase(std::unique(check.underflow_lines.begin(), check.underflow_lines.end()), check.underflow_lines.end());
+
+		check.verified = check.underflow_lines.empty() && check.unknown_line < 0;
+		check.depths   = std::move(depth);
+		return check;
+	}
+};